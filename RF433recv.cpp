@@ -53,6 +53,9 @@ static void rf433recv_assert_failed(unsigned int line) {
     Serial.print(F("\nRF433recv.cpp:"));
     Serial.print(line);
     Serial.println(F(": assertion failed, aborted."));
+#endif
+#ifdef RF433RECV_HOST
+    abort();
 #endif
     while (1)
         ;
@@ -67,12 +70,50 @@ IRAM_ATTR
 #endif
 void handle_int_receive();
 
+static rf_handler_t channel_handler(byte ch);
+#ifdef SIMULATE_INTERRUPTS
+static EdgeSource *timings_edge_source();
+#endif
+
+struct recset_t;
+static bool process_signal_all_receivers(recset_t *rs,
+        duration_t compact_signal_duration, byte signal_val);
+
+    // The RF_manager of each channel, nullptr if the channel is free. See
+    // "Channels".
+static RF_manager *managers[RF433RECV_MAX_MANAGERS];
+
+    // The signals recorded by the interrupt handler, waiting to be decoded,
+    // per channel
+static SignalRing<sbuf_entry_t, BUFFER_SIGNALS_NB>
+    sbuf[RF433RECV_MAX_MANAGERS];
+
+#ifdef RF433RECV_CHANNEL_STATS
+    // Per channel: the statistics of the window being recorded (updated by the
+    // interrupt handler), the millis() when it started, and the windows
+    // recorded (a ring, stats_next being the next one to write), see
+    // RF_manager::get_channel_stats().
+static channel_stats_t stats_current[RF433RECV_MAX_MANAGERS];
+static uint32_t stats_t0[RF433RECV_MAX_MANAGERS];
+static channel_stats_t
+    stats_windows[RF433RECV_MAX_MANAGERS][RF433RECV_STATS_NB_WINDOWS];
+static byte stats_next[RF433RECV_MAX_MANAGERS];
+static byte stats_nb[RF433RECV_MAX_MANAGERS];
+#endif
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+    // The codes decoded, waiting for do_events() to execute their callbacks,
+    // per channel
+static SignalRing<rf_frame_t, RF433RECV_FRAME_QUEUE_NB>
+    frame_queue[RF433RECV_MAX_MANAGERS];
+#endif
+
 
 // * **************** *********************************************************
 // * MeasureExecTimes *********************************************************
 // * **************** *********************************************************
 
-#ifdef DEBUG_EXEC_TIMES
+#if defined(DEBUG_EXEC_TIMES) || defined(DEBUG_LATENCIES)
 
 // In this code area, we are debugging anyway -> we can use variables (like the
 // buffer below) of big size, without optimizing anything.
@@ -92,6 +133,10 @@ static void serial_printf(const char *fmt, ...) {
     Serial.print(serial_printf_buffer);
 }
 
+#endif
+
+#ifdef DEBUG_EXEC_TIMES
+
 MeasureExecTimes::MeasureExecTimes(unsigned long int arg_reset_every):
         dmin(0),
         dmax(0),
@@ -169,20 +214,112 @@ void output_measureexectimes_stats() {
 #endif
 
 
+// * **************** *********************************************************
+// * LatencyHistogram *********************************************************
+// * **************** *********************************************************
+
+#ifdef DEBUG_LATENCIES
+
+// Bucket b counts the durations d such that 2^(b - 1) <= d < 2^b (bucket 0
+// counts null durations), except the last one that counts all durations
+// above.
+// Counts saturate at 65535.
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (byte b = 0; b < LATENCY_NB_BUCKETS; ++b)
+        count[b] = 0;
+    dmax = 0;
+}
+
+void LatencyHistogram::add(unsigned long d) {
+    if (d > dmax)
+        dmax = d;
+
+    byte b = 0;
+    while (d && b < LATENCY_NB_BUCKETS - 1) {
+        d >>= 1;
+        ++b;
+    }
+    if (count[b] != 0xffff)
+        ++count[b];
+}
+
+    // Outputs non-empty buckets only, as "<UPPER_BOUND:COUNT", where
+    // UPPER_BOUND is in microseconds.
+void LatencyHistogram::output_stats(const char *name, byte n) const {
+    assert(name);
+    serial_printf("[r%-2u %-4s] max %7lu |", n, name, dmax);
+    for (byte b = 0; b < LATENCY_NB_BUCKETS; ++b) {
+        if (!count[b])
+            continue;
+        if (b == LATENCY_NB_BUCKETS - 1) {
+            serial_printf(" >=%lu:%u", 1UL << (b - 1), count[b]);
+        } else {
+            serial_printf(" <%lu:%u", 1UL << b, count[b]);
+        }
+    }
+    serial_printf("\n");
+}
+
+    // For each receiver, in the order of registration:
+    //   WAIT is the time between the end of a code (the separator has been
+    //        processed) and the execution of callbacks
+    //   CALL is the duration of each callback
+    // (of all RF_manager objects, one after the other).
+void output_latencies_stats() {
+    byte n = 1;
+    for (byte ch = 0; ch < RF433RECV_MAX_MANAGERS; ++ch) {
+        if (!managers[ch])
+            continue;
+        for (Receiver *ptr_rec = managers[ch]->get_head(); ptr_rec;
+                ptr_rec = ptr_rec->get_next()) {
+            ptr_rec->output_latencies_stats(n++);
+        }
+    }
+    serial_printf("\n");
+}
+
+#endif
+
+
 // * ********* ****************************************************************
 // * BitVector ****************************************************************
 // * ********* ****************************************************************
 
+    // Bits are stored in the order they are received: the first bit received
+    // is the most significant bit of array[0], and so on. add_bit() then only
+    // writes one bit at the cursor (nb_bits), whatever the length of the
+    // vector, and get_nth_bit() and get_nth_byte() do the reordering.
 BitVector::BitVector(byte arg_target_nb_bits):
         target_nb_bits(arg_target_nb_bits),
         target_nb_bytes((arg_target_nb_bits + 7) >> 3),
-        nb_bits(0) {
+        nb_bits(0),
+        own_array(true),
+        hash_is_valid(false) {
     assert(target_nb_bytes);
     array = (uint8_t*)malloc(target_nb_bytes);
 }
 
+    // The storage is provided by the caller (it must be at least
+    // (arg_target_nb_bits + 7) / 8 bytes long) and is not freed by the
+    // destructor.
+BitVector::BitVector(byte arg_target_nb_bits, uint8_t *storage):
+        array(storage),
+        target_nb_bits(arg_target_nb_bits),
+        target_nb_bytes((arg_target_nb_bits + 7) >> 3),
+        nb_bits(0),
+        own_array(false),
+        hash_is_valid(false) {
+    assert(target_nb_bytes);
+    assert(array);
+}
+
 BitVector::~BitVector() {
-    if (array)
+    if (array && own_array)
         free(array);
 }
 
@@ -192,78 +329,78 @@ void BitVector::prepare_BitVector_construction(short arg_nb_bits,
     assert((arg_nb_bits + 7) >> 3 == arg_nb_bytes);
     assert(arg_nb_bytes == n);
     array = (uint8_t*)malloc(arg_nb_bytes);
+    own_array = true;
+    hash_is_valid = false;
+    target_nb_bits = arg_nb_bits;
     target_nb_bytes = arg_nb_bytes;
-    nb_bits = arg_nb_bits;
+    nb_bits = 0;
+}
+
+    // bytes[0] is the most significant byte. Bits above arg_nb_bits in
+    // bytes[0] are ignored.
+void BitVector::load_bytes(short arg_nb_bits, short arg_nb_bytes,
+        const byte *bytes, short n) {
+    assert(arg_nb_bits > 0 && arg_nb_bits <= target_nb_bits);
+    assert((arg_nb_bits + 7) >> 3 == arg_nb_bytes);
+    assert(arg_nb_bytes == n);
+    nb_bits = 0;
+    for (short i = arg_nb_bits - 1; i >= 0; --i)
+        add_bit((bytes[n - 1 - (i >> 3)] >> (i & 0x07)) & 0x01);
 }
 
 BitVector::BitVector(short arg_nb_bits, short arg_nb_bytes, byte b0,
         byte b1) {
+    const byte b[] = {b0, b1};
     prepare_BitVector_construction(arg_nb_bits, arg_nb_bytes, 2);
-    array[1] = b0;
-    array[0] = b1;
+    load_bytes(arg_nb_bits, arg_nb_bytes, b, 2);
 }
 
 BitVector::BitVector(short arg_nb_bits, short arg_nb_bytes, byte b0, byte b1,
         byte b2) {
+    const byte b[] = {b0, b1, b2};
     prepare_BitVector_construction(arg_nb_bits, arg_nb_bytes, 3);
-    array[2] = b0;
-    array[1] = b1;
-    array[0] = b2;
+    load_bytes(arg_nb_bits, arg_nb_bytes, b, 3);
 }
 
 BitVector::BitVector(short arg_nb_bits, short arg_nb_bytes, byte b0, byte b1,
         byte b2, byte b3) {
+    const byte b[] = {b0, b1, b2, b3};
     prepare_BitVector_construction(arg_nb_bits, arg_nb_bytes, 4);
-    array[3] = b0;
-    array[2] = b1;
-    array[1] = b2;
-    array[0] = b3;
+    load_bytes(arg_nb_bits, arg_nb_bytes, b, 4);
 }
 
 BitVector::BitVector(short arg_nb_bits, short arg_nb_bytes, byte b0, byte b1,
         byte b2, byte b3, byte b4) {
+    const byte b[] = {b0, b1, b2, b3, b4};
     prepare_BitVector_construction(arg_nb_bits, arg_nb_bytes, 5);
-    array[4] = b0;
-    array[3] = b1;
-    array[2] = b2;
-    array[1] = b3;
-    array[0] = b4;
+    load_bytes(arg_nb_bits, arg_nb_bytes, b, 5);
 }
 
 BitVector::BitVector(short arg_nb_bits, short arg_nb_bytes, byte b0, byte b1,
         byte b2, byte b3, byte b4, byte b5) {
+    const byte b[] = {b0, b1, b2, b3, b4, b5};
     prepare_BitVector_construction(arg_nb_bits, arg_nb_bytes, 6);
-    array[5] = b0;
-    array[4] = b1;
-    array[3] = b2;
-    array[2] = b3;
-    array[1] = b4;
-    array[0] = b5;
+    load_bytes(arg_nb_bits, arg_nb_bytes, b, 6);
 }
 
 void BitVector::reset() {
     assert(array);
     nb_bits = 0;
-    *array = 0;
+    hash_is_valid = false;
 }
 
 void BitVector::add_bit(byte v) {
+    assert(nb_bits < target_nb_bits);
+
+    byte mask = (0x80 >> (nb_bits & 0x07));
+    uint8_t *p = array + (nb_bits >> 3);
+        // Starting a new byte: clear it, so that bits not yet received are 0
+    if (mask == 0x80)
+        *p = 0;
+    if (v)
+        *p |= mask;
     ++nb_bits;
-    assert(nb_bits <= target_nb_bits);
-
-    for (short i = target_nb_bytes - 1; i >= 0; --i) {
-
-        byte b;
-            // b must be 0 or 1, hence the !! sequences below
-        if (i > 0) {
-            b = !!(array[i - 1] & 0x80);
-        } else {
-            b = !!v;
-        }
-
-        array[i]= (array[i] << 1) | b;
-
-    }
+    hash_is_valid = false;
 }
 
 int BitVector::get_nb_bits() const {
@@ -274,18 +411,26 @@ byte BitVector::get_nb_bytes() const {
     return (nb_bits + 7) >> 3;
 }
 
-    // Bit numbering starts at 0
+    // Bit numbering starts at 0, bit 0 being the last bit received
 byte BitVector::get_nth_bit(byte n) const {
     assert(n >= 0 && n < nb_bits);
-    byte index = (n >> 3);
-    byte bitread = (1 << (n & 0x07));
-    return !!(array[index] & bitread);
+    byte k = nb_bits - 1 - n;
+    return (array[k >> 3] >> (7 - (k & 0x07))) & 0x01;
 }
 
-    // Bit numbering starts at 0
+    // Byte numbering starts at 0, byte 0 being made of the last 8 bits
+    // received.
+    // As bits are stored from the most significant bit of array[0], when
+    // nb_bits is not a multiple of 8, each byte is made of the end of an
+    // array byte and the beginning of the next one.
 byte BitVector::get_nth_byte(byte n) const {
     assert(n >= 0 && n < get_nb_bytes());
-    return array[n];
+    byte j = get_nb_bytes() - 1 - n;
+    byte pad = (8 - (nb_bits & 0x07)) & 0x07;
+    if (!pad)
+        return array[j];
+    uint16_t w = (j ? (uint16_t)array[j - 1] << 8 : 0) | array[j];
+    return (byte)(w >> pad);
 }
 
     // *IMPORTANT*
@@ -320,6 +465,9 @@ char* BitVector::to_str() const {
     return ret;
 }
 
+    // Bits not yet received in the last byte are always 0 (see add_bit()),
+    // so that two vectors of the same number of bits can be compared byte per
+    // byte, the first byte holding the most significant bits.
 short BitVector::cmp(const BitVector *p) const {
     assert(p);
     short cmp_nb_bits = (get_nb_bits() > p->get_nb_bits());
@@ -329,25 +477,86 @@ short BitVector::cmp(const BitVector *p) const {
     if (cmp_nb_bits)
         return cmp_nb_bits;
 
-    for (int i = get_nb_bits() - 1; i >= 0; --i) {
-        byte v1 = get_nth_bit(i);
-        byte v2 = p->get_nth_bit(i);
-        if (v1 > v2)
+    byte nb_bytes = get_nb_bytes();
+    for (byte i = 0; i < nb_bytes; ++i) {
+        if (array[i] > p->array[i])
             return 1;
-        if (v1 < v2)
+        if (array[i] < p->array[i])
             return -1;
     }
 
     return 0;
 }
 
+    // Two vectors that have different hashes are different. The hash is
+    // calculated on first call, and then cached until the vector changes.
+uint16_t BitVector::get_hash() const {
+    if (!hash_is_valid) {
+        uint16_t h = nb_bits;
+        byte nb_bytes = get_nb_bytes();
+        for (byte i = 0; i < nb_bytes; ++i)
+            h = ((h << 5) | (h >> 11)) ^ array[i];
+        hash = h;
+        hash_is_valid = true;
+    }
+    return hash;
+}
+
+    // Copies the bits, as stored (get_nb_bytes() bytes), to dst.
+void BitVector::copy_bits_to(uint8_t *dst) const {
+    memcpy(dst, array, get_nb_bytes());
+}
+
+    // The reverse of copy_bits_to().
+void BitVector::load_bits(byte arg_nb_bits, const uint8_t *src) {
+    assert(arg_nb_bits <= target_nb_bits);
+    nb_bits = arg_nb_bits;
+    memcpy(array, src, get_nb_bytes());
+    hash_is_valid = false;
+}
+
+    // Copies the bits of src (that must fit in the target number of bits).
+void BitVector::load_from(const BitVector *src) {
+    load_bits(src->get_nb_bits(), src->array);
+}
+
+
+// * ********** ***************************************************************
+// * RF433Arena ***************************************************************
+// * ********** ***************************************************************
+
+    // Objects are aligned like pointers, that is enough for the objects the
+    // library allocates (no double or 64-bit integer on 32-bit boards).
+void *RF433Arena::alloc(size_t n) {
+    const uintptr_t a = alignof(void*);
+    const size_t pad = (size_t)(-(uintptr_t)(buf + used) & (a - 1));
+    if (pad + n > size - used)
+        return nullptr;
+    void *p = buf + used + pad;
+    used += pad + n;
+    return p;
+}
+
+    // Placement in an arena, as in
+    //   T *p = new (*arena) T(...);
+    // As it is declared noexcept, p is nullptr (and T constructor is not
+    // called) when the arena is full.
+void *operator new(size_t n, RF433Arena& arena) noexcept {
+    return arena.alloc(n);
+}
+
+void operator delete(void *, RF433Arena&) noexcept { }
+
 
 // * ****************** *******************************************************
 // * compact, uncompact *******************************************************
 // * ****************** *******************************************************
 
 // compact() aims to represent 16-bit integers in 8-bit, to the cost of
-// precision.
+// precision. The way it is done depends on DURATION_ENCODING (see
+// RF433recv.h).
+//
+// DURATION_COMPACT8
 // The three sets (first one looses 4 bits, middle looses 7, last looses 12)
 // have been chosen so that smaller durations don't loose too much precision.
 // The higher the number, the more precision gets lost. This could be seen as
@@ -361,41 +570,34 @@ short BitVector::cmp(const BitVector *p) const {
 // In this archive, the file
 //   test_compact.cpp
 // contains code to test compact/uncompact results, for a few numbers.
-duration_t compact(uint16_t u) {
-#ifdef NO_COMPACT_DURATIONS
-        // compact not activated -> compact() is a no-op
-    return u;
+//
+// DURATION_LOG8
+// This one goes all the way of floating point numbers: the duration, in units
+// of 8 us, is represented by a 3-bit exponent and a 5-bit mantissa (with an
+// implicit leading 1, except for the durations below 512 us that are
+// represented as is). Steps are 8 us below 512 us (16 us with
+// DURATION_COMPACT8), and then grow with the duration so that they always
+// stay between 1/64 and 1/32 of it. Durations of 32256 us and above are all
+// represented by 255 (46080 us and above with DURATION_COMPACT8).
+//
+// DURATION_RAW16
+// compact() is a no-op.
+//
+// compact() and uncompact() are defined in RF433recv.h, as constexpr, so that
+// make_automat() can be evaluated at compile time.
+
+#if defined(RF433RECV_CALIBRATION) || defined(RF433RECV_DISCOVERY)
+    // Middle of the durations d is the compacted value of (uncompact() returns
+    // the lowest one), to average durations.
+static inline uint16_t uncompact_mid(duration_t d) {
+#if DURATION_ENCODING == DURATION_RAW16
+    return d;
 #else
-    if (u < 2048) {
-        return u >> 4;
-    }
-    if (u < 17408) {
-        return 128 + ((u - 2048) >> 7);
-    }
-    if (u < 46080)
-        return 248 + ((u - 17408) >> 12);
-    return 255;
-#endif
-}
-
-// uncompact() is the opposite of compact(), yes!
-// Left here in case tests are needed (it is not used in release code).
-//uint16_t uncompact(duration_t b) {
-//#ifdef NO_COMPACT_DURATIONS
-//         compact not activated -> uncompact() is a no-op
-//    return b;
-//#else
-//    uint16_t u = b;
-//    if (u < 128) {
-//        return u << 4;
-//    }
-//    u &= 0x7f;
-//    if (u < 120) {
-//        return (u << 7) + 2048;
-//    }
-//    return ((u - 120) << 12) + 17408;
-//#endif
-//}
+    return d == 255 ? uncompact(d)
+        : uncompact(d) + ((uncompact(d + 1) - uncompact(d)) >> 1);
+#endif
+}
+#endif
 
 
 // * ********** ***************************************************************
@@ -404,7 +606,7 @@ duration_t compact(uint16_t u) {
 
 // The below one corresponds to RFMOD_TRIBIT
 
-const autoline_t automat_tribit[] PROGMEM = {
+constexpr autoline_t automat_tribit[] PROGMEM = {
 
 // Below, (T) means 'next status if test returns true'
 //        (F) means 'next status if test returns false'
@@ -449,7 +651,7 @@ const autoline_t automat_tribit[] PROGMEM = {
 // IMPORTANT - FIXME (TODO actually)
 // ***NOT TESTED WITH A PREFIX***
 // IN REAL CONDITIONS, TESTED ONLY *WITHOUT* PREFIX
-const autoline_t automat_tribit_inverted[] PROGMEM = {
+constexpr autoline_t automat_tribit_inverted[] PROGMEM = {
 
 // Below, (T) means 'next status if test returns true' and
 //        (F) means 'next status if test returns false'.
@@ -496,7 +698,7 @@ const autoline_t automat_tribit_inverted[] PROGMEM = {
 
 // The below one corresponds to RFMOD_MANCHESTER
 
-const autoline_t automat_manchester[] PROGMEM = {
+constexpr autoline_t automat_manchester[] PROGMEM = {
 
 // Below, (T) means 'next status if test returns true' and
 //        (F) means 'next status if test returns false'.
@@ -569,159 +771,205 @@ Wow<sizeof(automat_tribit)
     wow;
 #endif
 
-    // TODO (?)
-    // The boundaries are calculated so that a given signal length will be
-    // identified as "short versus long" as follows:
-    //   short <=> duration in [short / 4, avg(short, long)]
-    //   long  <=> duration in [avg(short, long) + 1, long * 1.5]
-    // (The use of compact numbers will also modify these boundaries a bit, but
-    // this is another story.)
-    //
-    // This is a bit laxist. Stricter ranges could be:
-    //   short <=> duration in [short * 0.75, short * 1.25]
-    //   long  <=> duration in [long * 0.75, long * 1.25]
-    //
-    // As the author prefers the laxist way, providing stricter decoding would
-    // require an additional argument when building automat, like for example...
-    //   enum class DecodeMood {LAXIST, STRICT};
-    // ...to change the calculation of boundaries accordingly.
-    //
-    // For now the author prefers to keep it simple, and always go the laxist
-    // way.  ;-D
-void get_boundaries(uint16_t sig_short, uint16_t sig_long, duration_t *pvalues,
-        byte ad_idx_short_inf, byte ad_idx_short_sup,
-        byte ad_idx_long_inf, byte ad_idx_long_sup) {
-
-    if (sig_short != sig_long) {
-
-        bool is_inverted = false;
-
-            // Normally the short is... shorter than the long, yes!
-            // But, some specs (in RCSwitch) work the other way round, and we
-            // have to handle it gracefully.
-        if (sig_short > sig_long) {
-            is_inverted = true;
-            uint16_t tmp = sig_short;
-            sig_short = sig_long;
-            sig_long = tmp;
-        }
+// * ************************** *************************************************
+// * Shared edge classification *************************************************
+// * ************************** *************************************************
 
-        pvalues[ad_idx_short_inf] = compact(sig_short >> 2);
-        pvalues[ad_idx_short_sup] = compact((sig_short + sig_long) >> 1);
-        pvalues[ad_idx_long_inf] = pvalues[ad_idx_short_sup] + 1;
-        pvalues[ad_idx_long_sup] = compact(sig_long + (sig_long >> 1));
-
-        if (is_inverted) {
-            duration_t tmp_vinf = pvalues[ad_idx_short_inf];
-            duration_t tmp_vsup = pvalues[ad_idx_short_sup];
-            pvalues[ad_idx_short_inf] = pvalues[ad_idx_long_inf];
-            pvalues[ad_idx_short_sup] = pvalues[ad_idx_long_sup];
-            pvalues[ad_idx_long_inf] = tmp_vinf;
-            pvalues[ad_idx_long_sup] = tmp_vsup;
-        }
+#if defined(SHARED_EDGE_CLASSIFICATION) || defined(RF433RECV_CALIBRATION)
+#define EDGE_CLASSES
+#endif
 
-    } else {
-            // This one is a bit special.
-            // It is meant to handle cases like "RCSwitch protocol 8" where the
-            // hi signal has no 'short' and 'long' durations, only the lo one
-            // differs.
-        pvalues[ad_idx_short_inf] = compact(sig_short >> 1);
-        pvalues[ad_idx_short_sup] = compact(sig_short + (sig_short >> 1));
-        pvalues[ad_idx_long_inf] = pvalues[ad_idx_short_inf];
-        pvalues[ad_idx_long_sup] = pvalues[ad_idx_short_sup];
-    }
+#ifdef EDGE_CLASSES
+
+// With SHARED_EDGE_CLASSIFICATION defined, the W_CHECK_DURATION lines don't
+// compare the signal duration with the receiver boundaries.
+// Instead, each receiver has a table that gives, for every possible
+// (compacted) duration, the classes the duration belongs to (short, long,
+// separator, ...), as a bit mask. The classes of a signal are then one table
+// lookup, and each W_CHECK_DURATION line becomes a bit test.
+//
+// The table takes 256 x 2 bytes of RAM per receiver. It is allocated along
+// with the receiver (in the arena, if one is set, see RF_manager::set_arena()),
+// and filled when registering and recalibrating the receiver.
+//
+// RF433RECV_CALIBRATION uses the classes, too, to know which duration a
+// signal matched (see "Calibration" below).
+//
+// The classes (edge_class_idx) are defined in RF433recv.h.
+
+static_assert(EC_NB <= 16, "edge classes must fit in a uint16_t");
+
+constexpr byte edge_class_bounds[EC_NB][2] = {
+    { AD_INITSEQ_INF,      ADX_DMAX },            // EC_INITSEQ
+    { AD_LO_PREFIX_INF,    AD_LO_PREFIX_SUP },    // EC_LO_PREFIX
+    { AD_HI_PREFIX_INF,    AD_HI_PREFIX_SUP },    // EC_HI_PREFIX
+    { AD_FIRST_LO_IGN_INF, AD_FIRST_LO_IGN_SUP }, // EC_FIRST_LO_IGN
+    { AD_LO_SHORT_INF,     AD_LO_SHORT_SUP },     // EC_LO_SHORT
+    { AD_LO_LONG_INF,      AD_LO_LONG_SUP },      // EC_LO_LONG
+    { AD_HI_SHORT_INF,     AD_HI_SHORT_SUP },     // EC_HI_SHORT
+    { AD_HI_LONG_INF,      AD_HI_LONG_SUP },      // EC_HI_LONG
+    { AD_LO_LAST_INF,      AD_LO_LAST_SUP },      // EC_LO_LAST
+    { AD_SEP_INF,          ADX_DMAX },            // EC_SEP
+    { AD_LO_SHORT_INF,     AD_LO_LONG_SUP },      // EC_LO_ANY
+    { AD_HI_SHORT_INF,     AD_HI_LONG_SUP }       // EC_HI_ANY
+};
+
+constexpr byte edge_class(byte idx_min, byte idx_max, byte c = 0) {
+    return c >= EC_NB ? EC_NONE
+        : (edge_class_bounds[c][0] == idx_min
+                && edge_class_bounds[c][1] == idx_max) ? c
+        : edge_class(idx_min, idx_max, c + 1);
+}
+
+constexpr byte automat_line_edge_class(const autoline_t *mat, byte s) {
+    return mat[s].w != W_CHECK_DURATION ? EC_NONE
+        : edge_class(mat[s].ad_field_idx_minval, mat[s].ad_field_idx_maxval);
+}
+
+    // Verifies at compile time that every W_CHECK_DURATION line has a class.
+constexpr bool automat_is_classified(const autoline_t *mat, byte len,
+        byte s = 0) {
+    return s >= len ? true
+        : (mat[s].w == W_CHECK_DURATION
+                && automat_line_edge_class(mat, s) == EC_NONE) ? false
+        : automat_is_classified(mat, len, s + 1);
+}
+static_assert(automat_is_classified(automat_tribit, TRIBIT_NB_ELEMS)
+        && automat_is_classified(automat_tribit_inverted,
+            TRIBIT_INVERTED_NB_ELEMS)
+        && automat_is_classified(automat_manchester, MANCHESTER_NB_ELEMS),
+        "a W_CHECK_DURATION line has boundaries missing in edge_class_bounds");
+
+    // The class of each automat line, stored alongside the automat (see
+    // automat_desc_t::mat_edge_classes), generated from the automats tables.
+template<byte... I> struct ec_seq { };
+template<byte N, byte... I> struct ec_make_seq:
+    ec_make_seq<N - 1, N - 1, I...> { };
+template<byte... I> struct ec_make_seq<0, I...> {
+    typedef ec_seq<I...> type;
+};
+
+template<const autoline_t *MAT, class SEQ> struct EdgeClassLines;
+template<const autoline_t *MAT, byte... I>
+struct EdgeClassLines<MAT, ec_seq<I...>> {
+    static const byte cls[sizeof...(I)];
+};
+template<const autoline_t *MAT, byte... I>
+const byte EdgeClassLines<MAT, ec_seq<I...>>::cls[sizeof...(I)] PROGMEM = {
+    automat_line_edge_class(MAT, I)...
+};
+
+#define EDGE_CLASS_LINES(mat, len) \
+    (EdgeClassLines<mat, ec_make_seq<len>::type>::cls)
+
+#endif // EDGE_CLASSES
+
+
+    // The automat table of each mod, see autoexec_t.
+struct automat_desc_t {
+    const autoline_t *mat;
+    byte mat_len;
+#ifdef EDGE_CLASSES
+    const byte *mat_edge_classes;
+#endif
+};
+
+#ifdef EDGE_CLASSES
+#define AUTOMAT_DESC(mat, len) { mat, len, EDGE_CLASS_LINES(mat, len) }
+#else
+#define AUTOMAT_DESC(mat, len) { mat, len }
+#endif
+
+    // Indexed by mod (RFMOD_ constants)
+static const automat_desc_t automat_descs[] = {
+    AUTOMAT_DESC(automat_tribit, TRIBIT_NB_ELEMS),
+    AUTOMAT_DESC(automat_tribit_inverted, TRIBIT_INVERTED_NB_ELEMS),
+    AUTOMAT_DESC(automat_manchester, MANCHESTER_NB_ELEMS)
+};
+static_assert(RFMOD_TRIBIT == 0 && RFMOD_TRIBIT_INVERTED == 1
+        && RFMOD_MANCHESTER == 2, "automat_descs is indexed by mod");
+
+#undef AUTOMAT_DESC
+
+void automat_invalid_arguments() {
+    assert(false);
 }
 
-// TODO
-//   build_automat should be turned into autoexec_t constructor
+    // The values are calculated by make_automat() (see RF433recv.h).
+    //
+    // About AD_BIT_0 and AD_BIT_1 values:
+    // Will allow one day, to invert decoding.
+    // For now, these two values are clearly useless, as RF433recv API does
+    // not provide a way to invert decoding.
+    // Well, to be more precise, it does not provide a DIRECT way of inverting
+    // decoding.
+    // But, you can exchange short and long durations (in register_Receiver
+    // call), this'll flip 0 and 1 decoded bits.
+    //
+    // About AD_NEXT_SPECIAL value, with RFMOD_TRIBIT_INVERTED:
+    // If hi_short == hi_long, then the signal has the below shape:
+    //
+    //   First duration (tirets) is high signal
+    //   Second duration (underscores) is low signal
+    //     --- __     => hi 'short', lo short
+    //     --- ____   => hi 'short', lo long
+    //
+    // 'short' is written in quotes, because it is neither short, nor long:
+    // there is a unique duration, but the automat happens to identify it as
+    // short.
+    //
+    // This means, at the time we 'identify' the hi signal duration, we
+    // identify it (wrongly) as short and then, expect a long duration
+    // thereafter, because regular tribit means encoding is made of ('hi short
+    // then lo long' versus 'hi long then lo short').
+    // However in this instance (hi_short == hi_long), we should instead check
+    // if the following lo signal is short or long, to deduct the bit coding.
+    //
+    // This is the purpose of the derivation (line 22 of
+    // automat_tribit_inverted).
+    //
+    // FYI This coding corresponds to RCSwitch protocol 9.
 autoexec_t* build_automat(byte mod, uint16_t initseq, uint16_t lo_prefix,
         uint16_t hi_prefix, uint16_t first_lo_ign, uint16_t lo_short,
         uint16_t lo_long, uint16_t hi_short, uint16_t hi_long, uint16_t lo_last,
-        uint16_t sep, byte nb_bits) {
+        uint16_t sep, byte nb_bits, autoexec_t *pax) {
+    const automat_args_t args = { mod, initseq, lo_prefix, hi_prefix,
+        first_lo_ign, lo_short, lo_long, hi_short, hi_long, lo_last, sep,
+        nb_bits, DecodeMood::LAXIST, 0 };
+    return build_automat(args, pax);
+}
+
+autoexec_t* build_automat(const automat_args_t& args, autoexec_t *pax) {
 
 #ifdef DEBUG_AUTOMAT
     dbgf("== mod = %d, initseq = %u, lo_prefix = %u, hi_prefix = %u, "
-            "first_lo_ign = %u\n", mod, initseq, lo_prefix, hi_prefix,
-            first_lo_ign);
+            "first_lo_ign = %u\n", args.mod, args.initseq, args.lo_prefix,
+            args.hi_prefix, args.first_lo_ign);
     dbgf("== lo_short = %u, lo_long = %u, hi_short = %u, hi_long = %u\n",
-            lo_short, lo_long, hi_short, hi_long);
+            args.lo_short, args.lo_long, args.hi_short, args.hi_long);
     dbgf("== lo_last = %u, sep = %u, nb_bits = %d\n",
-            lo_last, sep, nb_bits);
+            args.lo_last, args.sep, args.nb_bits);
+    dbgf("== mood = %d, tolerance = %d\n", (int)args.mood, args.tolerance);
 #endif
 
-    if (mod != RFMOD_MANCHESTER) {
-        assert((lo_prefix && hi_prefix) || (!lo_prefix && !hi_prefix));
-        assert((hi_short && hi_long) || (!hi_short && !hi_long));
-        if (!hi_short && !hi_long) {
-            hi_short = lo_short;
-            hi_long = lo_long;
-        }
+    if (args.mod != RFMOD_MANCHESTER) {
+        assert(args.mod == RFMOD_TRIBIT || args.mod == RFMOD_TRIBIT_INVERTED);
+        assert((args.lo_prefix && args.hi_prefix)
+                || (!args.lo_prefix && !args.hi_prefix));
+        assert((args.hi_short && args.hi_long)
+                || (!args.hi_short && !args.hi_long));
     } else {
-        assert(!lo_prefix && !hi_prefix);
-        lo_long = lo_short << 1;
-        if (!hi_short)
-            hi_short = lo_short;
-        hi_long = hi_short << 1;
+        assert(!args.lo_prefix && !args.hi_prefix);
     }
+    assert(args.mood != DecodeMood::CUSTOM
+            || (args.tolerance && args.tolerance <= 100));
 
-    autoexec_t *pax = new autoexec_t;
-    duration_t *pvalues = pax->values;
-
-    get_boundaries(lo_short, lo_long, pvalues,
-            AD_LO_SHORT_INF, AD_LO_SHORT_SUP, AD_LO_LONG_INF, AD_LO_LONG_SUP);
-
-    get_boundaries(hi_short, hi_long, pvalues,
-            AD_HI_SHORT_INF, AD_HI_SHORT_SUP, AD_HI_LONG_INF, AD_HI_LONG_SUP);
-
-    pvalues[AD_SEP_INF] = compact(sep - (sep >> 2));
-
-    duration_t long_sup = (pvalues[AD_LO_LONG_SUP] >= pvalues[AD_HI_LONG_SUP]
-            ? pvalues[AD_LO_LONG_SUP] : pvalues[AD_HI_LONG_SUP]);
-    if (pvalues[AD_SEP_INF] <= long_sup)
-        pvalues[AD_SEP_INF] = long_sup + 1;
-
-    pvalues[AD_INITSEQ_INF] = compact(initseq - (initseq >> 2));
-
-    if (lo_prefix) {
-        pvalues[AD_LO_PREFIX_INF] = compact(lo_prefix - (lo_prefix >> 2));
-        pvalues[AD_LO_PREFIX_SUP] = compact(lo_prefix + (lo_prefix >> 2));
-        pvalues[AD_HI_PREFIX_INF] = compact(hi_prefix - (hi_prefix >> 2));
-        pvalues[AD_HI_PREFIX_SUP] = compact(hi_prefix + (hi_prefix >> 2));
-    } else {
-            // Not necessary (unused if lo_prefix is zero)... but cleaner.
-            // I put a value anyway, it is cleaner because in case the values
-            // are tested (this without a doubt would be a bug), the bad
-            // consequences will be repeatable, whatever it'll be.
-            // Why choosing 32000?
-            //   Why not?
-        pvalues[AD_LO_PREFIX_INF] = compact(32000);
-        pvalues[AD_LO_PREFIX_SUP] = compact(32000);
-        pvalues[AD_HI_PREFIX_INF] = compact(32000);
-        pvalues[AD_HI_PREFIX_SUP] = compact(32000);
-    }
-
-    pvalues[AD_LO_LAST_INF] =
-        (lo_last ? compact(lo_last >> 1) : pvalues[AD_LO_SHORT_INF]);
-    pvalues[AD_LO_LAST_SUP] =
-        (lo_last ? compact(lo_last + (lo_last >> 1)) : pvalues[AD_LO_LONG_SUP]);
-
-    pvalues[AD_FIRST_LO_IGN_INF] = compact(first_lo_ign >> 1);
-    pvalues[AD_FIRST_LO_IGN_SUP] =
-        compact(first_lo_ign + (first_lo_ign >> 1));
-
-    pvalues[AD_NB_BITS] = nb_bits;
-
-        // Will allow one day, to invert decoding.
-        // For now, these two pvalues are clearly useless, as RF433recv API does
-        // not provide a way to invert decoding.
-        // Well, to be more precise, it does not provide a DIRECT way of
-        // inverting decoding.
-        // But, you can exchange short and long durations (in register_Receiver
-        // call), this'll flip 0 and 1 decoded bits.
-    pvalues[AD_BIT_0] = 0;
-    pvalues[AD_BIT_1] = 1;
+    if (!pax)
+        pax = new autoexec_t;
+    *pax = make_automat(args);
 
 #ifdef DEBUG_AUTOMAT
+    const duration_t *pvalues = pax->values;
     dbgf("c_lo_short_inf = %5u\n"
          "c_lo_short_sup = %5u\n"
          "c_lo_long_inf  = %5u\n"
@@ -741,89 +989,321 @@ autoexec_t* build_automat(byte mod, uint16_t initseq, uint16_t lo_prefix,
          pvalues[AD_NB_BITS]);
 #endif
 
-    switch (mod) {
+    return pax;
+}
+
 
-    case RFMOD_TRIBIT:
+// * ******************** *****************************************************
+// * Specialized automats *****************************************************
+// * ******************** *****************************************************
+
+#ifdef SPECIALIZED_AUTOMATS
+
+// With SPECIALIZED_AUTOMATS defined, the automats are not interpreted at run
+// time (see Receiver::process_signal()): the compiler generates one function
+// per automat line, in which what to do, the values to compare with and the
+// next lines are constants.
+// - The lines that don't wait for a new signal are chained by direct calls
+//   (no loop, no reading of the automat table).
+// - AD_INDIRECT jumps are resolved at compile time, too: the automat is
+//   instanciated once per possible value of AD_NEXT_PREFIX and AD_NEXT_SPECIAL
+//   (template parameters NP and NS below), and each Receiver picks the
+//   instance that corresponds to its values.
+//
+// The automats tables above remain the one and only definition of the
+// automats, the generated code is derived from them.
+
+constexpr byte automat_len(byte mod) {
+    return mod == RFMOD_TRIBIT ? TRIBIT_NB_ELEMS
+        : mod == RFMOD_TRIBIT_INVERTED ? TRIBIT_INVERTED_NB_ELEMS
+        : MANCHESTER_NB_ELEMS;
+}
+
+constexpr const autoline_t& automat_line(byte mod, byte s) {
+    return mod == RFMOD_TRIBIT ? automat_tribit[s]
+        : mod == RFMOD_TRIBIT_INVERTED ? automat_tribit_inverted[s]
+        : automat_manchester[s];
+}
+
+constexpr byte spec_resolve(byte next, byte np, byte ns) {
+    return !(next & AD_INDIRECT) ? next
+        : ((next & ~AD_INDIRECT) == AD_NEXT_PREFIX ? np : ns);
+}
+
+    // Tells whether execution stops when reaching line n (= it is time to
+    // wait for the next signal).
+    // Lines out of the automat correspond to 'never taken' branches (like 99
+    // in the 'next if false' of a W_RESET_BITS line).
+constexpr bool spec_is_stop(byte mod, byte n) {
+    return n >= automat_len(mod)
+        || automat_line(mod, n).w == W_WAIT_SIGNAL
+        || automat_line(mod, n).w == W_TERMINATE;
+}
+
+template<class A, byte N, bool STOP> struct SpecNext {
+    static inline byte go(Receiver *self, duration_t d, byte v) {
+        return A::template step<N>(self, d, v);
+    }
+};
+
+template<class A, byte N> struct SpecNext<A, N, true> {
+    static inline byte go(Receiver *, duration_t, byte) {
+        return N;
+    }
+};
+
+template<byte MOD, byte NP, byte NS>
+class SpecAutomat {
+    public:
+        static byte dispatch(Receiver *self, byte status, duration_t d,
+                byte v);
 
-        pax->mat_len = TRIBIT_NB_ELEMS;
-        pax->mat = automat_tribit;
-        pvalues[AD_NEXT_PREFIX] = lo_prefix ? 18  : 3;
+        template<byte S> static inline byte step(Receiver *self,
+                duration_t d, byte v);
 
+    private:
+        template<byte IDX> static inline duration_t val(const Receiver *self);
+};
+
+    // Same as Receiver::get_val(), with idx known at compile time.
+template<byte MOD, byte NP, byte NS>
+template<byte IDX>
+inline duration_t SpecAutomat<MOD, NP, NS>::val(const Receiver *self) {
+    return IDX < AD_NB_FIELDS ? self->pax->values[IDX < AD_NB_FIELDS ? IDX : 0]
+        : IDX == ADX_ZERO ? 0
+        : IDX == ADX_ONE ? 1
+            // ADX_DMAX is compact(65535), that is, the biggest duration_t
+        : IDX == ADX_DMAX ? (duration_t)~(duration_t)0
+        : IDX == ADX_NB_BITS_M1 ? self->pax->values[AD_NB_BITS] - 1
+        : 42;   // ADX_UNDEF - value returned does not matter
+}
+
+template<byte MOD, byte NP, byte NS>
+template<byte S>
+inline byte SpecAutomat<MOD, NP, NS>::step(Receiver *self, duration_t d,
+        byte v) {
+    constexpr byte w = automat_line(MOD, S).w;
+    constexpr byte idx_min = automat_line(MOD, S).ad_field_idx_minval;
+    constexpr byte idx_max = automat_line(MOD, S).ad_field_idx_maxval;
+    constexpr byte next_t =
+        spec_resolve(automat_line(MOD, S).next_if_w_true, NP, NS);
+    constexpr byte next_f =
+        spec_resolve(automat_line(MOD, S).next_if_w_false, NP, NS);
+#ifdef EDGE_CLASSES
+    constexpr byte ec = edge_class(idx_min, idx_max);
+#endif
+
+    bool r;
+    switch (w) {
+    case W_WAIT_SIGNAL:
+        r = (v >= val<idx_min>(self) && v <= val<idx_max>(self));
         break;
 
-    case RFMOD_TRIBIT_INVERTED:
+    case W_TERMINATE:
+        self->has_value = true;
+        r = true;
+        break;
 
-        pax->mat_len = TRIBIT_INVERTED_NB_ELEMS;
-        pax->mat = automat_tribit_inverted;
-            // As written earlier, not tested with a prefix
-        pvalues[AD_NEXT_PREFIX] = lo_prefix ? 18  : 3;
-
-            // If hi_short == hi_long, then the signal has the below shape:
-            //
-            //   First duration (tirets) is high signal
-            //   Second duration (underscores) is low signal
-            //     --- __     => hi 'short', lo short
-            //     --- ____   => hi 'short', lo long
-            //
-            // 'short' is written in quotes, because it is neither short, nor
-            // long: there is a unique duration, but the automat happens to
-            // identify it as short.
-            //
-            // This means, at the time we 'identify' the hi signal duration, we
-            // identify it (wrongly) as short and then, expect a long duration
-            // thereafter, because regular tribit means encoding is made of ('hi
-            // short then lo long' versus 'hi long then lo short').
-            // However in this instance (hi_short == hi_long), we should instead
-            // check if the following lo signal is short or long, to deduct the
-            // bit coding.
-            //
-            // This is the purpose of the derivation below.
-            //
-            // FYI This coding corresponds to RCSwitch protocol 9.
-        pvalues[AD_NEXT_SPECIAL] = (hi_short == hi_long ? 22 : 0);
+    case W_CHECK_DURATION:
+#ifdef SHARED_EDGE_CLASSIFICATION
+            // The test on EC_NB is for lines that are not W_CHECK_DURATION
+            // (this code is never executed for them, but it is compiled).
+        r = self->edge_class_table[d] & (1 << (ec < EC_NB ? ec : 0));
+#else
+        r = (d >= val<idx_min>(self) && d <= val<idx_max>(self));
+#endif
+#ifdef RF433RECV_CALIBRATION
+        if (r)
+            self->calibration_add(ec, d);
+#endif
+        break;
 
+    case W_RESET_BITS:
+        self->recorded->reset();
+        r = true;
         break;
 
-    case RFMOD_MANCHESTER:
+    case W_ADD_ZERO:
+        self->recorded->add_bit(self->pax->values[AD_BIT_0]);
+        r = true;
+        break;
+
+    case W_ADD_ONE:
+        self->recorded->add_bit(self->pax->values[AD_BIT_1]);
+        r = true;
+        break;
 
-        assert(!lo_prefix);
-        pax->mat_len = MANCHESTER_NB_ELEMS;
-        pax->mat = automat_manchester;
-        pvalues[AD_NEXT_PREFIX] = 255; // Not used
+    case W_CHECK_BITS:
+        {
+            duration_t nb_bits = self->recorded->get_nb_bits();
+            r = (nb_bits >= val<idx_min>(self)
+                    && nb_bits <= val<idx_max>(self));
+        }
         break;
 
     default:
-        assert(false);
+        r = false;
     }
 
-    return pax;
+    return r ?
+        SpecNext<SpecAutomat, next_t, spec_is_stop(MOD, next_t)>::go(self,
+                d, v)
+        :
+        SpecNext<SpecAutomat, next_f, spec_is_stop(MOD, next_f)>::go(self,
+                d, v);
+}
+
+#define SPEC_MAX_LINES 38
+static_assert(TRIBIT_NB_ELEMS <= SPEC_MAX_LINES
+        && TRIBIT_INVERTED_NB_ELEMS <= SPEC_MAX_LINES
+        && MANCHESTER_NB_ELEMS <= SPEC_MAX_LINES,
+        "SpecAutomat::dispatch() must have one case per automat line");
+
+    // Executes the automat from line status (a line that waits for a signal,
+    // or W_TERMINATE) and returns the next line to execute, once the next
+    // signal is there.
+template<byte MOD, byte NP, byte NS>
+byte SpecAutomat<MOD, NP, NS>::dispatch(Receiver *self, byte status,
+        duration_t d, byte v) {
+
+        // Cases above the automat length are never taken. They are mapped to
+        // line 0 to keep the compiler happy.
+#define SPEC_CASE(s) \
+    case s: return step<(s < automat_len(MOD) ? s : 0)>(self, d, v);
+
+    switch (status) {
+    SPEC_CASE(0)  SPEC_CASE(1)  SPEC_CASE(2)  SPEC_CASE(3)  SPEC_CASE(4)
+    SPEC_CASE(5)  SPEC_CASE(6)  SPEC_CASE(7)  SPEC_CASE(8)  SPEC_CASE(9)
+    SPEC_CASE(10) SPEC_CASE(11) SPEC_CASE(12) SPEC_CASE(13) SPEC_CASE(14)
+    SPEC_CASE(15) SPEC_CASE(16) SPEC_CASE(17) SPEC_CASE(18) SPEC_CASE(19)
+    SPEC_CASE(20) SPEC_CASE(21) SPEC_CASE(22) SPEC_CASE(23) SPEC_CASE(24)
+    SPEC_CASE(25) SPEC_CASE(26) SPEC_CASE(27) SPEC_CASE(28) SPEC_CASE(29)
+    SPEC_CASE(30) SPEC_CASE(31) SPEC_CASE(32) SPEC_CASE(33) SPEC_CASE(34)
+    SPEC_CASE(35) SPEC_CASE(36) SPEC_CASE(37)
+    }
+
+#undef SPEC_CASE
+
+    assert(false);
+    return 0;   // Never executed
 }
 
+    // The values of AD_NEXT_PREFIX and AD_NEXT_SPECIAL below are the ones set
+    // by make_automat().
+static spec_dispatch_t spec_get_dispatch(const autoexec_t *pax) {
+    const byte np = pax->values[AD_NEXT_PREFIX];
+    const byte ns = pax->values[AD_NEXT_SPECIAL];
+
+    switch (pax->mod) {
+
+    case RFMOD_TRIBIT:
+        assert(np == 18 || np == 3);
+        return np == 18 ? &SpecAutomat<RFMOD_TRIBIT, 18, 255>::dispatch
+                        : &SpecAutomat<RFMOD_TRIBIT, 3, 255>::dispatch;
+
+    case RFMOD_TRIBIT_INVERTED:
+        assert(np == 18 || np == 3);
+        assert(ns == 22 || ns == 0);
+        if (np == 18) {
+            return ns == 22
+                ? &SpecAutomat<RFMOD_TRIBIT_INVERTED, 18, 22>::dispatch
+                : &SpecAutomat<RFMOD_TRIBIT_INVERTED, 18, 0>::dispatch;
+        }
+        return ns == 22
+            ? &SpecAutomat<RFMOD_TRIBIT_INVERTED, 3, 22>::dispatch
+            : &SpecAutomat<RFMOD_TRIBIT_INVERTED, 3, 0>::dispatch;
+
+    case RFMOD_MANCHESTER:
+        return &SpecAutomat<RFMOD_MANCHESTER, 255, 255>::dispatch;
+
+    default:
+        assert(false);
+    }
+    return nullptr;   // Never executed
+}
+
+#endif // SPECIALIZED_AUTOMATS
+
 
 // * ******** *****************************************************************
 // * Receiver *****************************************************************
 // * ******** *****************************************************************
 
-Receiver::Receiver(autoexec_t *arg_pax, byte arg_n):
+    // If arg_recorded is provided, the receiver is allocated in an arena, like
+    // arg_pax, arg_recorded and the callbacks, and the destructor deletes none
+    // of them.
+    // If arg_owns_pax is false, arg_pax is not deleted by the destructor (it is
+    // typically a static variable built with make_automat()).
+Receiver::Receiver(const autoexec_t *arg_pax, byte arg_n,
+        BitVector *arg_recorded, bool arg_owns_pax):
         pax(arg_pax),
         n(arg_n),
         status(0),
+        recorded(arg_recorded),
         has_value(false),
+        owns_memory(!arg_recorded),
+        owns_pax(arg_owns_pax),
         callback_head(nullptr),
-        next(nullptr) {
+        callback_tail(nullptr),
+        callback_seq(0),
+        next(nullptr)
+#ifdef SHARED_EDGE_CLASSIFICATION
+        , edge_class_table(nullptr)
+#endif
+#ifdef DEBUG_LATENCIES
+        , complete_t(0)
+#endif
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        , value_t(0)
+        , channel(0)
+#endif
+        {
+
+    if (!recorded)
+        recorded = new BitVector(n);
 
-    recorded = new BitVector(n);
+    for (short i = 0; i < RF433RECV_CALLBACK_BUCKETS; ++i)
+        callback_buckets[i] = nullptr;
 
     assert(pax);
     assert(n);
     assert(recorded);
+
+#ifdef SPECIALIZED_AUTOMATS
+    spec_dispatch = spec_get_dispatch(pax);
+#endif
+#ifdef SHARED_EDGE_CLASSIFICATION
+        // In an arena, see set_edge_class_table()
+    if (owns_memory)
+        set_edge_class_table(new uint16_t[256]);
+#endif
+#ifdef RF433RECV_CALIBRATION
+    cal_has_args = false;
+    reset_calibration();
+#endif
 }
 
 Receiver::~Receiver() {
-    if (pax)
+    if (!owns_memory)
+        return;
+
+    if (pax && owns_pax)
         delete pax;
     if (recorded)
         delete recorded;
+#ifdef SHARED_EDGE_CLASSIFICATION
+    if (edge_class_table)
+        delete[] edge_class_table;
+#endif
+
+    for (short i = -1; i < RF433RECV_CALLBACK_BUCKETS; ++i) {
+        callback_t *pcb = (i < 0 ? callback_head : callback_buckets[i]);
+        while (pcb) {
+            callback_t *pcb_next = pcb->next;
+            delete pcb;
+            pcb = pcb_next;
+        }
+    }
 }
 
 void Receiver::reset() {
@@ -866,16 +1346,68 @@ inline duration_t Receiver::get_val(byte idx) const {
     return -42;   // Never executed
 }
 
-void Receiver::process_signal(duration_t compact_signal_duration,
+#ifdef SHARED_EDGE_CLASSIFICATION
+    // Returns the classes a (compacted) duration belongs to, for this
+    // receiver (one bit per class, see edge_class_bounds).
+uint16_t Receiver::get_edge_classes(duration_t d) const {
+    uint16_t classes = 0;
+    for (byte c = 0; c < EC_NB; ++c) {
+        if (w_compare(get_val(edge_class_bounds[c][0]),
+                    get_val(edge_class_bounds[c][1]), d))
+            classes |= (1 << c);
+    }
+    return classes;
+}
+
+    // Sets the table of classes of the receiver (256 entries, one per
+    // compacted duration), and fills it. Each entry is written with interrupts
+    // disabled, as the receiver may be decoding meanwhile (when recalibrating).
+void Receiver::set_edge_class_table(uint16_t *table) {
+    assert(table);
+    edge_class_table = table;
+    for (unsigned int d = 0; d < 256; ++d) {
+        const uint16_t classes = get_edge_classes(d);
+        cli();
+        edge_class_table[d] = classes;
+        sei();
+    }
+}
+#endif
+
+    // Executes the automat from line st (a line that waits for a signal, or
+    // W_TERMINATE), with the signal given, and returns the line reached (the
+    // next one that waits for a signal, or W_TERMINATE).
+inline byte Receiver::run(byte st, duration_t compact_signal_duration,
         byte signal_val) {
-    const autoline_t *mat = pax->mat;
+#ifdef DEBUG_LATENCIES
+    const byte st_in = st;
+#endif
+#ifdef SPECIALIZED_AUTOMATS
+    st = spec_dispatch(this, st, compact_signal_duration, signal_val);
+    assert(st < automat_descs[pax->mod].mat_len);
+#else
+    const automat_desc_t *desc = &automat_descs[pax->mod];
+    const autoline_t *mat = desc->mat;
+#ifdef SHARED_EDGE_CLASSIFICATION
+    const uint16_t edge_classes = edge_class_table[compact_signal_duration];
+#endif
     byte new_w;
     do {
-        const autoline_t *current = &mat[status];
+        const autoline_t *current = &mat[st];
         const byte w = pgm_read_byte(&current->w);
 
+#ifdef SHARED_EDGE_CLASSIFICATION
+            // W_CHECK_DURATION does not need boundaries (see below).
+        duration_t minv = 0;
+        duration_t maxv = 0;
+        if (w != W_CHECK_DURATION) {
+            minv = get_val(pgm_read_byte(&current->ad_field_idx_minval));
+            maxv = get_val(pgm_read_byte(&current->ad_field_idx_maxval));
+        }
+#else
         duration_t minv = get_val(pgm_read_byte(&current->ad_field_idx_minval));
         duration_t maxv = get_val(pgm_read_byte(&current->ad_field_idx_maxval));
+#endif
 
         bool r;
         switch (w) {
@@ -889,7 +1421,18 @@ void Receiver::process_signal(duration_t compact_signal_duration,
             break;
 
         case W_CHECK_DURATION:
+#ifdef SHARED_EDGE_CLASSIFICATION
+            r = edge_classes
+                & (1 << pgm_read_byte(&desc->mat_edge_classes[st]));
+#else
             r = w_compare(minv, maxv, compact_signal_duration);
+#endif
+#ifdef RF433RECV_CALIBRATION
+            if (r) {
+                calibration_add(pgm_read_byte(&desc->mat_edge_classes[st]),
+                        compact_signal_duration);
+            }
+#endif
             break;
 
         case W_RESET_BITS:
@@ -923,86 +1466,944 @@ void Receiver::process_signal(duration_t compact_signal_duration,
         if (next_status & AD_INDIRECT)
             next_status = pax->values[next_status & ~AD_INDIRECT];
 
-        assert(next_status < pax->mat_len);
+        assert(next_status < desc->mat_len);
 
 #ifdef DEBUG_AUTOMAT
         dbgf("d = %u, n = %d, status = %d, w = %d, next_status = %d",
-                compact_signal_duration, recorded->get_nb_bits(), status, w,
+                compact_signal_duration, recorded->get_nb_bits(), st, w,
                 next_status);
 #endif
 
-        status = next_status;
-        new_w = pgm_read_byte(&mat[status].w);
+        st = next_status;
+        new_w = pgm_read_byte(&mat[st].w);
     } while (new_w != W_TERMINATE && new_w != W_WAIT_SIGNAL);
+#endif
+#ifdef DEBUG_LATENCIES
+        // The code is complete (W_TERMINATE gets executed with the next
+        // signal).
+    if (st != st_in
+            && pgm_read_byte(&automat_descs[pax->mod].mat[st].w) == W_TERMINATE)
+        complete_t = micros();
+#endif
+    return st;
 }
 
-void Receiver::attach(Receiver* ptr_rec) {
-    assert(!next);
-    next = ptr_rec;
+void Receiver::process_signal(duration_t compact_signal_duration,
+        byte signal_val) {
+    status = run(status, compact_signal_duration, signal_val);
 }
 
-callback_t* Receiver::get_callback_tail() const {
-    const callback_t* pcb = callback_head;
-    if (pcb) {
-        while (pcb->next)
-            pcb = pcb->next;
+    // Processes the signals of edges, one after the other, until the receiver
+    // has a value (with the frame queue, until a value can't be queued).
+    // Returns the number of signals processed (the receiver has a value if
+    // it is below n, or if the last signal gave a value).
+    // Equivalent to calling process_signal() for each signal, but the status
+    // stays in a local variable, and in status 0 (waiting for an
+    // initialization sequence), the signals that can't be one are skipped.
+size_t Receiver::process_signals(const sbuf_entry_t *edges, size_t n) {
+    byte st = status;
+    const duration_t initseq_inf = pax->values[AD_INITSEQ_INF];
+    size_t i = 0;
+    while (i < n && !has_value) {
+
+            // Same as in process_signal_all_receivers(): in status 0, only a
+            // high signal long enough changes something.
+        if (!st) {
+            while (i < n && (!edges[i].signal_val
+                        || edges[i].compact_signal_duration < initseq_inf)) {
+                ++i;
+            }
+            if (i == n)
+                break;
+        }
+
+        const duration_t d = edges[i].compact_signal_duration;
+        const byte v = edges[i].signal_val;
+        ++i;
+
+        st = run(st, d, v);
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        if (has_value && queue_value())
+            st = 0;
+#endif
     }
-    return (callback_t*)pcb;
+    status = st;
+    return i;
 }
 
-void Receiver::add_callback(callback_t *pcb) {
-    callback_t *pcb_tail = get_callback_tail();
-    if (pcb_tail)
-        pcb_tail->next = pcb;
-    else
-        callback_head = pcb;
+void Receiver::attach(Receiver* ptr_rec) {
+    assert(!next);
+    next = ptr_rec;
+}
+
+    // Callbacks registered without a code are appended to the list starting
+    // at callback_head, the others to the list of the bucket of their code.
+    // Both lists are then in the order of registration (seq).
+void Receiver::add_callback(callback_t *pcb) {
+    pcb->seq = callback_seq++;
+    pcb->next = nullptr;
+    if (!pcb->pcode) {
+        if (callback_tail)
+            callback_tail->next = pcb;
+        else
+            callback_head = pcb;
+        callback_tail = pcb;
+        return;
+    }
+
+    callback_t **ppcb = &callback_buckets[pcb->pcode->get_hash()
+        & (RF433RECV_CALLBACK_BUCKETS - 1)];
+    while (*ppcb)
+        ppcb = &(*ppcb)->next;
+    *ppcb = pcb;
 }
 
+    // Executes the callbacks of the value of the receiver, and resets it.
 byte Receiver::execute_callbacks() {
+#ifdef RF433RECV_CALIBRATION
+    calibration_commit();
+#endif
+#if defined(RF433RECV_FRAME_QUEUE_NB)
+    const byte ret = execute_callbacks(recorded, value_t);
+#elif defined(DEBUG_LATENCIES)
+    const byte ret = execute_callbacks(recorded, complete_t);
+#else
+    const byte ret = execute_callbacks(recorded, 0);
+#endif
+    reset();
+    return ret;
+}
+
+    // Executes the callbacks of code, that got complete at code_t (micros(),
+    // used by DEBUG_LATENCIES only).
+    // The callbacks without a code and the callbacks of the bucket of code
+    // are walked together, by order of registration, so that the callbacks
+    // are executed in the order they got registered.
+byte Receiver::execute_callbacks(const BitVector *code, unsigned long code_t) {
     uint32_t t0 = millis();
 
+#ifdef DEBUG_LATENCIES
+    latency_wait.add(micros() - code_t);
+#endif
+
     byte ret = 0;
 
-    callback_t *pcb = callback_head;
-    while (pcb) {
+    const uint16_t hash = code->get_hash();
+    callback_t *pcb_any = callback_head;
+    callback_t *pcb_code =
+        callback_buckets[hash & (RF433RECV_CALLBACK_BUCKETS - 1)];
+    while (pcb_any || pcb_code) {
+
+        callback_t *pcb;
+        if (!pcb_code || (pcb_any && pcb_any->seq < pcb_code->seq)) {
+            pcb = pcb_any;
+            pcb_any = pcb_any->next;
+        } else {
+            pcb = pcb_code;
+            pcb_code = pcb_code->next;
+        }
+
+            // The hash filters out nearly all codes of the bucket that don't
+            // match, without comparing bits (hashes are cached).
+        if (pcb->pcode && (pcb->pcode->get_hash() != hash
+                           || pcb->pcode->cmp(code))) {
+            continue;
+        }
 
         if (!pcb->min_delay_between_two_calls
                 || !pcb->last_trigger
                 || t0 >= pcb->last_trigger + pcb->min_delay_between_two_calls) {
 
-            if (!pcb->pcode || !pcb->pcode->cmp(recorded)) {
-                pcb->last_trigger = t0;
-                pcb->func(recorded);
-                ++ret;
+            pcb->last_trigger = t0;
+#ifdef DEBUG_LATENCIES
+            const unsigned long t_call = micros();
+#endif
+            pcb->func(code);
+#ifdef DEBUG_LATENCIES
+            latency_call.add(micros() - t_call);
+#endif
+            ++ret;
+        }
+    }
+
+    return ret;
+}
+
+#ifdef DEBUG_LATENCIES
+void Receiver::output_latencies_stats(byte num) const {
+    latency_wait.output_stats("WAIT", num);
+    latency_call.output_stats("CALL", num);
+}
+#endif
+
+
+// * *********** **************************************************************
+// * Calibration **************************************************************
+// * *********** **************************************************************
+
+#ifdef RF433RECV_CALIBRATION
+
+// With RF433RECV_CALIBRATION defined, each duration that matches a
+// W_CHECK_DURATION line of a receiver is added to the sum of its class (short,
+// long, prefix, ..., see edge_class_idx), for the code being received. The
+// sums restart with each initialization sequence.
+// Once a code is complete (when its callbacks get executed), the average
+// duration of each class in the code updates the running average of the
+// class, that is then used by recalibrate() in place of the duration given to
+// register_Receiver().
+//
+// The initialization sequence and the separator are not measured: their
+// range has no upper boundary, so there is nothing to centre (and what gets
+// measured includes the silence before the code).
+
+    // Weight of the last code in the running averages is 1 / CAL_AVG_WEIGHT
+#define CAL_AVG_WEIGHT 4
+
+    // Fields of automat_args_t, indexed by (class - EC_LO_PREFIX)
+static uint16_t automat_args_t::* const cal_arg_fields[CAL_NB_CLASSES] = {
+    &automat_args_t::lo_prefix,
+    &automat_args_t::hi_prefix,
+    &automat_args_t::first_lo_ign,
+    &automat_args_t::lo_short,
+    &automat_args_t::lo_long,
+    &automat_args_t::hi_short,
+    &automat_args_t::hi_long,
+    &automat_args_t::lo_last
+};
+
+void Receiver::set_calibration_args(const automat_args_t& args) {
+    cal_args = args;
+    cal_has_args = true;
+}
+
+void Receiver::calibration_start() {
+    for (byte i = 0; i < CAL_NB_CLASSES; ++i) {
+        cal_code_sum[i] = 0;
+        cal_code_nb[i] = 0;
+    }
+}
+
+inline void Receiver::calibration_add(byte ec,
+        duration_t compact_signal_duration) {
+    if (ec == EC_INITSEQ) {
+        calibration_start();
+    } else if (ec >= EC_LO_PREFIX && ec <= EC_LO_LAST) {
+        cal_code_sum[ec - EC_LO_PREFIX] +=
+            uncompact_mid(compact_signal_duration);
+        ++cal_code_nb[ec - EC_LO_PREFIX];
+    }
+}
+
+void Receiver::calibration_commit() {
+    for (byte i = 0; i < CAL_NB_CLASSES; ++i) {
+        if (!cal_code_nb[i])
+            continue;
+        const int32_t d = cal_code_sum[i] / cal_code_nb[i];
+        if (!cal_nb_codes[i])
+            cal_avg[i] = d;
+        else
+            cal_avg[i] += (d - (int32_t)cal_avg[i]) / CAL_AVG_WEIGHT;
+        if (cal_nb_codes[i] < 255)
+            ++cal_nb_codes[i];
+    }
+    calibration_start();
+}
+
+void Receiver::reset_calibration() {
+    calibration_start();
+    for (byte i = 0; i < CAL_NB_CLASSES; ++i) {
+        cal_avg[i] = 0;
+        cal_nb_codes[i] = 0;
+    }
+}
+
+    // ec is a class from EC_LO_PREFIX to EC_LO_LAST.
+    // Returns 0 if no code got measured.
+uint16_t Receiver::get_calibrated_duration(byte ec) const {
+    assert(ec >= EC_LO_PREFIX && ec <= EC_LO_LAST);
+    return cal_nb_codes[ec - EC_LO_PREFIX] ? cal_avg[ec - EC_LO_PREFIX] : 0;
+}
+
+byte Receiver::get_calibration_nb_codes(byte ec) const {
+    assert(ec >= EC_LO_PREFIX && ec <= EC_LO_LAST);
+    return cal_nb_codes[ec - EC_LO_PREFIX];
+}
+
+    // Restores the durations of the classes registered with the same duration
+    // as the short or the long one, if short and long came out in another
+    // order than registered (or merged, or split): the boundaries of
+    // make_automat() rely on this order.
+static void cal_keep_order(automat_args_t *args, const automat_args_t& prev,
+        uint16_t automat_args_t::* const sh,
+        uint16_t automat_args_t::* const lg) {
+    const int8_t prev_cmp = (prev.*sh > prev.*lg) - (prev.*sh < prev.*lg);
+    const int8_t cmp = (args->*sh > args->*lg) - (args->*sh < args->*lg);
+    if (cmp == prev_cmp)
+        return;
+    for (byte i = 0; i < CAL_NB_CLASSES; ++i) {
+        const uint16_t d = prev.*cal_arg_fields[i];
+        if (d && (d == prev.*sh || d == prev.*lg))
+            args->*cal_arg_fields[i] = d;
+    }
+}
+
+    // Rebuilds the automat values with the measured durations, for the
+    // classes measured in at least min_codes codes. The durations that were
+    // 0 when registering (meaning, 'not used' or 'take the default') are left
+    // untouched.
+    // Classes registered with the same duration (like lo_short and lo_long
+    // of a code that encodes bits in the high signal only) get the same value,
+    // the average of all of them, and the order of short and long is kept.
+    // Returns false if nothing changed, or if the receiver got registered
+    // with an autoexec_t built beforehand (see make_automat()), as the
+    // arguments are then unknown.
+bool Receiver::recalibrate(byte min_codes) {
+    if (!cal_has_args)
+        return false;
+
+    automat_args_t args = cal_args;
+    for (byte i = 0; i < CAL_NB_CLASSES; ++i) {
+        const uint16_t d = cal_args.*cal_arg_fields[i];
+        if (!d)
+            continue;
+        uint32_t sum = 0;
+        uint16_t nb = 0;
+        for (byte j = 0; j < CAL_NB_CLASSES; ++j) {
+            if (cal_args.*cal_arg_fields[j] == d && cal_nb_codes[j]
+                    && cal_nb_codes[j] >= min_codes && cal_avg[j]) {
+                sum += (uint32_t)cal_avg[j] * cal_nb_codes[j];
+                nb += cal_nb_codes[j];
             }
         }
+        if (nb)
+            args.*cal_arg_fields[i] = (sum + nb / 2) / nb;
+    }
+    cal_keep_order(&args, cal_args, &automat_args_t::lo_short,
+            &automat_args_t::lo_long);
+    cal_keep_order(&args, cal_args, &automat_args_t::hi_short,
+            &automat_args_t::hi_long);
+
+    bool changed = false;
+    for (byte i = 0; i < CAL_NB_CLASSES; ++i) {
+        if (args.*cal_arg_fields[i] != cal_args.*cal_arg_fields[i])
+            changed = true;
+    }
+    if (!changed)
+        return false;
 
-        pcb = pcb->next;
+        // The automat line numbers don't depend on the durations, so the
+        // code being received (if any) goes on with the new values.
+        // The automat pax points to is not written to: the new values go to
+        // cal_ax, and pax gets switched to it.
+    const autoexec_t ax = make_automat(args);
+    const autoexec_t *prev_pax = pax;
+    cli();
+    cal_ax = ax;
+    pax = &cal_ax;
+#ifdef SPECIALIZED_AUTOMATS
+    spec_dispatch = spec_get_dispatch(pax);
+#endif
+    sei();
+#ifdef SHARED_EDGE_CLASSIFICATION
+    set_edge_class_table(edge_class_table);
+#endif
+
+    if (prev_pax != &cal_ax) {
+        if (owns_memory && owns_pax)
+            delete prev_pax;
+        owns_pax = false;
     }
+    cal_args = args;
+    return true;
+}
+
+#endif // RF433RECV_CALIBRATION
+
+
+// * *********** **************************************************************
+// * Frame queue **************************************************************
+// * *********** **************************************************************
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+
+// With RF433RECV_FRAME_QUEUE_NB defined, a receiver that gets a value (when
+// executing W_TERMINATE) copies it in frame_queue and resets itself right
+// away, instead of waiting for do_events() to execute its callbacks. Then
+// do_events() executes the callbacks of the frames of the queue, in the order
+// they got received, and RF_manager::get_code_timestamp() tells when each one
+// got complete.
+// When the queue is full (or when the code does not fit in a frame), the
+// receiver keeps its value, as if there was no queue: codes received until
+// do_events() gets called are lost again, but no code already received is.
+// See RF_manager::get_frame_queue_overflows().
+
+    // Returns true if the value got queued (the receiver is then reset).
+bool Receiver::queue_value() {
+    value_t = micros();
+
+    const byte nb_bits = recorded->get_nb_bits();
+    if (nb_bits > RF433RECV_FRAME_MAX_BITS)
+        return false;
+
+    rf_frame_t frame;
+    frame.rec = this;
+    frame.t = value_t;
+    frame.nb_bits = nb_bits;
+    recorded->copy_bits_to(frame.bits);
+    if (!frame_queue[channel].push(frame))
+        return false;
+
+#ifdef RF433RECV_CALIBRATION
+    calibration_commit();
+#endif
     reset();
+    return true;
+}
+
+    // Gives back a queued value to the receiver, as if it had kept it. Meant
+    // to be called with the interrupt handler inactive.
+void Receiver::restore_value(const rf_frame_t *frame) {
+    recorded->load_bits(frame->nb_bits, frame->bits);
+    value_t = frame->t;
+    has_value = true;
+}
+
+#endif // RF433RECV_FRAME_QUEUE_NB
+
+
+// * ************* ************************************************************
+// * Receivers set ************************************************************
+// * ************* ************************************************************
+
+// Most of the time, most receivers are waiting for an initialization sequence
+// (status 0), and a signal changes their status only if it is high and at
+// least as long as their initialization sequence lower boundary
+// (AD_INITSEQ_INF). Also, a receiver that has a value stays as is until it
+// gets reset.
+// Therefore, receivers are processed (see process_signal_all_receivers()) as
+// follows:
+// - The ones in the middle of a code ('active') are recorded in a bitset, and
+//   all of them are processed.
+// - The other ones are sorted by AD_INITSEQ_INF, so that only the ones that
+//   can see an initialization sequence are processed.
+// A receiver leaves the bitset once back to status 0, or once it has a value
+// (note the value is set by W_TERMINATE, when processing the signal *after*
+// the one that ended the code). When reset from outside (status set to 0), it
+// stays in the bitset until the next signal, that is harmless.
+// Each channel (see "Channels") has its own set of receivers.
+// The receivers registered past RF433RECV_MAX_RECEIVERS are not in the set:
+// they are processed on every signal, by walking the list of receivers from
+// the first of them (overflow).
+
+#ifdef __AVR__
+typedef byte recset_word_t;
+#else
+typedef uint32_t recset_word_t;
+#endif
+#define RECSET_WORD_BITS (sizeof(recset_word_t) * 8)
+#define RECSET_NB_WORDS \
+    ((RF433RECV_MAX_RECEIVERS + RECSET_WORD_BITS - 1) / RECSET_WORD_BITS)
+
+struct recset_t {
+        // In order of registration
+    Receiver *receivers[RF433RECV_MAX_RECEIVERS];
+    byte nb;
+    recset_word_t active[RECSET_NB_WORDS];
+
+        // Indexes in receivers, sorted by AD_INITSEQ_INF
+    byte by_initseq[RF433RECV_MAX_RECEIVERS];
+    duration_t initseq_inf[RF433RECV_MAX_RECEIVERS];
+
+        // The first receiver registered past RF433RECV_MAX_RECEIVERS
+    Receiver *overflow;
+};
+
+static recset_t recsets[RF433RECV_MAX_MANAGERS];
+
+static inline byte recset_ctz(recset_word_t w) {
+#ifdef __AVR__
+    return __builtin_ctz(w);
+#else
+    return __builtin_ctzl(w);
+#endif
+}
+
+    // To be called before ptr_rec gets appended to the list of receivers.
+static void recset_add(recset_t *rs, Receiver *ptr_rec) {
+    if (rs->nb >= RF433RECV_MAX_RECEIVERS) {
+        cli();
+        if (!rs->overflow)
+            rs->overflow = ptr_rec;
+        sei();
+        return;
+    }
+
+    const duration_t inf = ptr_rec->get_initseq_inf();
+
+    cli();
+    byte i = rs->nb;
+    while (i && rs->initseq_inf[i - 1] > inf) {
+        rs->by_initseq[i] = rs->by_initseq[i - 1];
+        rs->initseq_inf[i] = rs->initseq_inf[i - 1];
+        --i;
+    }
+    rs->by_initseq[i] = rs->nb;
+    rs->initseq_inf[i] = inf;
+    rs->receivers[rs->nb] = ptr_rec;
+    ++rs->nb;
+    sei();
+}
+
+static void recset_clear(recset_t *rs) {
+    cli();
+    rs->nb = 0;
+    rs->overflow = nullptr;
+    for (byte w = 0; w < RECSET_NB_WORDS; ++w)
+        rs->active[w] = 0;
+    sei();
+}
+
+    // Updates the set of active receivers, once receiver idx has been
+    // processed.
+    // Returns true if the receiver has a value.
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static inline bool recset_update(recset_t *rs, byte idx) {
+    const Receiver *ptr_rec = rs->receivers[idx];
+    const bool has_value = ptr_rec->get_has_value();
+    const recset_word_t bit = (recset_word_t)1 << (idx % RECSET_WORD_BITS);
+    if (has_value || !ptr_rec->get_status())
+        rs->active[idx / RECSET_WORD_BITS] &= ~bit;
+    else
+        rs->active[idx / RECSET_WORD_BITS] |= bit;
+    return has_value;
+}
+
+    // Processes one receiver.
+    // Returns true if the receiver got a value (with the frame queue, even if
+    // it got queued).
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static inline bool recset_process_receiver(Receiver *ptr_rec,
+        duration_t compact_signal_duration, byte signal_val) {
+
+#ifdef DEBUG_AUTOMAT
+    dbgf("\nptr_rec = %lu", (unsigned long)ptr_rec);
+#endif
+
+    ptr_rec->process_signal(compact_signal_duration, signal_val);
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        // Whether the value gets queued (the receiver is then reset) or kept,
+        // do_events() has something to do.
+    if (ptr_rec->get_has_value()) {
+        ptr_rec->queue_value();
+        return true;
+    }
+#endif
+    return ptr_rec->get_has_value();
+}
 
+    // Processes one receiver of the set and updates the set of active
+    // receivers accordingly.
+    // Returns true if the receiver got a value, see recset_process_receiver().
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static inline bool recset_process(recset_t *rs, byte idx,
+        duration_t compact_signal_duration, byte signal_val) {
+    const bool ret = recset_process_receiver(rs->receivers[idx],
+            compact_signal_duration, signal_val);
+    recset_update(rs, idx);
     return ret;
 }
 
 
+// * ********* ****************************************************************
+// * Discovery ****************************************************************
+// * ********* ****************************************************************
+
+#ifdef RF433RECV_DISCOVERY
+
+// With RF433RECV_DISCOVERY defined, RF_manager can record signals (see
+// RF_manager::start_discovery()) and work out the arguments of
+// register_Receiver() from them (see RF_manager::discover()), as follows.
+// 1. For each level, the durations are counted in a histogram of logarithmic
+//    bins (8 per octave). Its highest peaks give the clusters of durations:
+//    the short and long durations of each level (the most frequent ones), and
+//    the separator (a longer high duration).
+// 2. Candidate arguments are made of the clusters, for each cluster of high
+//    durations taken as the separator, for each modulation and for a few
+//    numbers of bits around the one estimated from the signals found
+//    between two separators.
+// 3. Each candidate is validated by running its automat on the recorded
+//    signals, and counting the codes that are the same as the code before
+//    (at least DISCOVERY_MIN_REPEATS). The candidate for which this count
+//    times the number of bits is the highest wins (so that a candidate with
+//    more bits, that explains more signals, wins over one with less).
+//
+// Prefixes are not discovered, nor is lo_last (the default range, from short
+// to long, applies).
+
+#define DISCOVERY_BINS_PER_OCTAVE 8
+#define DISCOVERY_NB_BINS (16 * DISCOVERY_BINS_PER_OCTAVE)
+    // Clusters kept, per level
+#define DISCOVERY_NB_CLUSTERS 4
+    // A cluster spreads up to this number of bins on each side of its peak
+    // (+/- 18%)
+#define DISCOVERY_CLUSTER_BINS 2
+    // Number of times a candidate must decode the same code as the one
+    // before, to be retained
+#define DISCOVERY_MIN_REPEATS 1
+    // Codes with less bits are not discovered (too easy to find in noise)
+#define DISCOVERY_MIN_BITS 8
+    // Number of frames (signals between two separators) looked at to estimate
+    // the number of bits
+#define DISCOVERY_NB_FRAMES 16
+
+    // One RF_manager at a time records signals (start_discovery() asserts it):
+    // discovery rarely runs for long, and the buffer can be big.
+static sbuf_entry_t *discovery_buf = nullptr;
+static uint16_t discovery_size = 0;
+    // The channel whose signals are recorded
+static byte discovery_channel = 0;
+    // Written by the interrupt handler
+static volatile uint16_t discovery_len = 0;
+
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static inline void discovery_record(byte ch, const sbuf_entry_t& entry) {
+    if (ch == discovery_channel && discovery_len < discovery_size)
+        discovery_buf[discovery_len++] = entry;
+}
+
+struct discovery_cluster_t {
+    uint16_t avg;   // In microseconds
+    uint16_t nb;    // Number of signals
+};
+
+    // Bin of the histogram of durations, for duration u (in microseconds).
+    // The 3 bits after the most significant one make the position inside an
+    // octave.
+static byte discovery_bin(uint16_t u) {
+    if (!u)
+        return 0;
+    byte e = 15;
+    while (!(u & 0x8000)) {
+        u <<= 1;
+        --e;
+    }
+    return (e << 3) | ((u >> 12) & 7);
+}
+
+    // Fills clusters with the clusters of durations of the signals of level
+    // signal_val (same meaning as in sbuf_entry_t), by decreasing number of
+    // signals, and returns their number.
+    // A cluster is made of the bins around a peak of the histogram, as long as
+    // the number of signals decreases.
+static byte discovery_clusters(const sbuf_entry_t *edges, uint16_t n,
+        byte signal_val, byte *hist, discovery_cluster_t *clusters) {
+    for (byte b = 0; b < DISCOVERY_NB_BINS; ++b)
+        hist[b] = 0;
+    for (uint16_t i = 0; i < n; ++i) {
+        if (edges[i].signal_val != signal_val)
+            continue;
+        const byte b =
+            discovery_bin(uncompact_mid(edges[i].compact_signal_duration));
+        if (hist[b] < 255)
+            ++hist[b];
+    }
+
+    byte nb = 0;
+    while (nb < DISCOVERY_NB_CLUSTERS) {
+        byte peak = 0;
+        for (byte b = 1; b < DISCOVERY_NB_BINS; ++b) {
+            if (hist[b] > hist[peak])
+                peak = b;
+        }
+            // A duration seen once is not a cluster
+        if (hist[peak] < 2)
+            break;
+
+        byte b_inf = peak;
+        while (b_inf > 0 && peak - b_inf < DISCOVERY_CLUSTER_BINS
+                && hist[b_inf - 1] && hist[b_inf - 1] <= hist[b_inf]) {
+            --b_inf;
+        }
+        byte b_sup = peak;
+        while (b_sup < DISCOVERY_NB_BINS - 1
+                && b_sup - peak < DISCOVERY_CLUSTER_BINS
+                && hist[b_sup + 1] && hist[b_sup + 1] <= hist[b_sup]) {
+            ++b_sup;
+        }
+
+        uint32_t sum = 0;
+        uint16_t count = 0;
+        for (uint16_t i = 0; i < n; ++i) {
+            if (edges[i].signal_val != signal_val)
+                continue;
+            const uint16_t u = uncompact_mid(edges[i].compact_signal_duration);
+            const byte b = discovery_bin(u);
+            if (b >= b_inf && b <= b_sup) {
+                sum += u;
+                ++count;
+            }
+        }
+        clusters[nb].avg = sum / count;
+        clusters[nb].nb = count;
+        ++nb;
+
+        for (byte b = b_inf; b <= b_sup; ++b)
+            hist[b] = 0;
+    }
+    return nb;
+}
+
+    // Sets d[0] and d[1] to the short and long durations, that are the two
+    // clusters with the most signals, below half of the separator (excluding
+    // cluster exclude).
+    // If only one is found, short and long are the same.
+    // Returns false if none is found.
+static bool discovery_short_long(const discovery_cluster_t *clusters, byte nb,
+        byte exclude, uint16_t sep, uint16_t *d) {
+    byte found = 0;
+    for (byte i = 0; i < nb && found < 2; ++i) {
+        if (i != exclude && clusters[i].avg < (sep >> 1))
+            d[found++] = clusters[i].avg;
+    }
+    if (!found)
+        return false;
+    if (found == 1)
+        d[1] = d[0];
+    if (d[0] > d[1]) {
+        const uint16_t tmp = d[0];
+        d[0] = d[1];
+        d[1] = tmp;
+    }
+    return true;
+}
+
+static void discovery_sort(uint32_t *t, byte n) {
+    for (byte i = 1; i < n; ++i) {
+        const uint32_t v = t[i];
+        byte j = i;
+        for (; j > 0 && t[j - 1] > v; --j)
+            t[j] = t[j - 1];
+        t[j] = v;
+    }
+}
+
+    // Looks at the signals between two separators (frames), and returns false
+    // if there are none.
+    // Sets the median number of signals of a frame, and the median duration
+    // of a frame.
+static bool discovery_frames(const sbuf_entry_t *edges, uint16_t n,
+        uint16_t sep, uint16_t *nb_signals, uint32_t *duration) {
+    uint32_t frame_nb[DISCOVERY_NB_FRAMES];
+    uint32_t frame_duration[DISCOVERY_NB_FRAMES];
+    byte nb_frames = 0;
+
+    const uint16_t sep_inf = sep - (sep >> 2);
+    uint16_t last_sep = 0;
+    bool has_sep = false;
+    uint32_t t = 0;
+    for (uint16_t i = 0; i < n; ++i) {
+        const uint16_t u = uncompact_mid(edges[i].compact_signal_duration);
+        if (edges[i].signal_val && u >= sep_inf) {
+            if (has_sep && i - last_sep > 1 && nb_frames < DISCOVERY_NB_FRAMES) {
+                frame_nb[nb_frames] = i - last_sep - 1;
+                frame_duration[nb_frames] = t;
+                ++nb_frames;
+            }
+            has_sep = true;
+            last_sep = i;
+            t = 0;
+        } else {
+            t += u;
+        }
+    }
+    if (!nb_frames)
+        return false;
+
+    discovery_sort(frame_nb, nb_frames);
+    discovery_sort(frame_duration, nb_frames);
+    *nb_signals = frame_nb[nb_frames >> 1];
+    *duration = frame_duration[nb_frames >> 1];
+    return true;
+}
+
+    // Runs the automat made of args on the recorded signals, and returns the
+    // number of codes that are the same as the code before.
+static uint16_t discovery_validate(const automat_args_t& args,
+        const sbuf_entry_t *edges, uint16_t n) {
+    if (!args.nb_bits || !automat_args_are_valid(args))
+        return 0;
+
+    const autoexec_t ax = make_automat(args);
+    Receiver rec(&ax, args.nb_bits, nullptr, false);
+    uint16_t repeats = 0;
+    bool has_prev = false;
+    uint16_t prev_hash = 0;
+    uint16_t next = 0;
+    while (next < n) {
+        const uint16_t i = next++;
+        const duration_t d = edges[i].compact_signal_duration;
+        rec.process_signal(d, edges[i].signal_val);
+        if (rec.get_has_value()) {
+            const uint16_t hash = rec.get_recorded()->get_hash();
+            if (has_prev && hash == prev_hash)
+                ++repeats;
+            prev_hash = hash;
+            has_prev = true;
+            rec.reset();
+                // The value is set with the signal that follows the code, and
+                // the code before it was the separator, that can be the
+                // initialization sequence of the next code: they are processed
+                // again (from i - 1), so that codes sent back to back all get
+                // decoded. A code takes more than two signals, so that this
+                // doesn't loop.
+            if (i >= 1)
+                next = i - 1;
+        }
+    }
+    return repeats;
+}
+
+    // Tries the candidates made with cluster isep of hi as the separator (and
+    // initialization sequence), and updates *result if one of them scores
+    // better than *best_score.
+static void discovery_try_sep(const sbuf_entry_t *edges, uint16_t n,
+        const discovery_cluster_t *lo, byte nb_lo,
+        const discovery_cluster_t *hi, byte nb_hi, byte isep,
+        uint32_t *best_score, automat_args_t *result) {
+    const uint16_t sep = hi[isep].avg;
+
+    uint16_t lo_d[2];
+    uint16_t hi_d[2];
+    uint16_t frame_nb;
+    uint32_t frame_duration;
+    if (!discovery_short_long(lo, nb_lo, 255, sep, lo_d)
+            || !discovery_short_long(hi, nb_hi, isep, sep, hi_d)
+            || !discovery_frames(edges, n, sep, &frame_nb, &frame_duration)) {
+        return;
+    }
+
+        // When high durations are the same as low ones, they are left to 0
+        // (meaning, same as low).
+    const bool hi_is_lo =
+        (hi_d[0] > lo_d[0] ? hi_d[0] - lo_d[0] : lo_d[0] - hi_d[0])
+            <= (lo_d[0] >> 3)
+        && (hi_d[1] > lo_d[1] ? hi_d[1] - lo_d[1] : lo_d[1] - hi_d[1])
+            <= (lo_d[1] >> 3);
+
+    automat_args_t a = { RFMOD_TRIBIT, sep, 0, 0, 0, lo_d[0], lo_d[1],
+        (uint16_t)(hi_is_lo ? 0 : hi_d[0]), (uint16_t)(hi_is_lo ? 0 : hi_d[1]),
+        0, sep, 0, DecodeMood::LAXIST, 0 };
+
+        // Number of bits, as estimated from a frame:
+        //   TRIBIT, TRIBIT_INVERTED  2 signals per bit, plus 1 (the last low
+        //                            signal, or the first one, ignored)
+        //   MANCHESTER               the duration of a bit is 2 short ones,
+        //                            plus 1 bit for synchronization
+    const int tribit_nb_bits = (frame_nb - 1) >> 1;
+    const int manchester_nb_bits =
+        (int)(frame_duration / (2 * (uint32_t)lo_d[0])) - 1;
+
+        // Candidates: TRIBIT, then TRIBIT_INVERTED with each cluster of low
+        // durations as the first low signal to ignore, then MANCHESTER.
+    for (byte c = 0; c < nb_lo + 2; ++c) {
+        a.mod = (c == 0 ? RFMOD_TRIBIT
+                : c <= nb_lo ? RFMOD_TRIBIT_INVERTED : RFMOD_MANCHESTER);
+        a.first_lo_ign =
+            (a.mod == RFMOD_TRIBIT_INVERTED ? lo[c - 1].avg : 0);
+        if (a.mod == RFMOD_TRIBIT_INVERTED && !a.first_lo_ign)
+            continue;
+        const int nb_est = (a.mod == RFMOD_MANCHESTER ?
+                manchester_nb_bits : tribit_nb_bits);
+        const int span = (a.mod == RFMOD_MANCHESTER ? 2 : 1);
+        for (int nb = nb_est - span; nb <= nb_est + span; ++nb) {
+            if (nb < DISCOVERY_MIN_BITS || nb > 255)
+                continue;
+            a.nb_bits = nb;
+            const uint16_t repeats = discovery_validate(a, edges, n);
+            const uint32_t score = (uint32_t)repeats * nb;
+            if (repeats >= DISCOVERY_MIN_REPEATS && score > *best_score) {
+                *best_score = score;
+                *result = a;
+            }
+        }
+    }
+}
+
+static bool discovery_analyze(const sbuf_entry_t *edges, uint16_t n,
+        automat_args_t *result) {
+    discovery_cluster_t lo[DISCOVERY_NB_CLUSTERS];
+    discovery_cluster_t hi[DISCOVERY_NB_CLUSTERS];
+    byte *hist = (byte*)malloc(DISCOVERY_NB_BINS);
+    if (!hist)
+        return false;
+    const byte nb_lo = discovery_clusters(edges, n, 0, hist, lo);
+    const byte nb_hi = discovery_clusters(edges, n, 1, hist, hi);
+    free(hist);
+
+        // Any high duration seen in several codes can be the separator (the
+        // initialization sequence and the separator can differ, like a
+        // separator followed by a long silence): each one is tried.
+    uint32_t best_score = 0;
+    for (byte isep = 0; isep < nb_hi; ++isep) {
+        if (hi[isep].nb > DISCOVERY_MIN_REPEATS) {
+            discovery_try_sep(edges, n, lo, nb_lo, hi, nb_hi, isep,
+                    &best_score, result);
+        }
+    }
+    return best_score > 0;
+}
+
+#endif // RF433RECV_DISCOVERY
+
+
 // * ********** ***************************************************************
 // * RF_manager ***************************************************************
 // * ********** ***************************************************************
 
+    // Takes the first free channel.
 RF_manager::RF_manager(byte arg_pin_input_num, byte arg_int_num):
+        channel(0),
+        pin_input_num(arg_pin_input_num),
+        head(nullptr),
+        deferred_decoding(false),
         int_num(arg_int_num),
+        gpio_source(arg_pin_input_num, arg_int_num),
+        edge_source(&gpio_source),
         opt_wait_free_433_is_set(false),
         opt_wait_free_433_timeout(0),
+        opt_wait_free_433_async(false),
+        wait_free_433_is_pending(false),
+        wait_free_433_t0(0),
+        occupancy_last16(0xffff),
+        occupancy_count_ok(16),
         handle_int_receive_interrupts_is_set(false),
         first_decoder_that_has_a_value_resets_others(false),
-        inactivate_interrupts_handler_when_a_value_has_been_received(false) {
-    pin_input_num = arg_pin_input_num;
-    head = nullptr;
+        inactivate_interrupts_handler_when_a_value_has_been_received(false),
+        decode_mood(DecodeMood::LAXIST),
+        decode_tolerance(0) {
+    while (channel < RF433RECV_MAX_MANAGERS && managers[channel])
+        ++channel;
+        // More RF_manager objects than RF433RECV_MAX_MANAGERS
+    assert(channel < RF433RECV_MAX_MANAGERS);
+    managers[channel] = this;
     ++obj_count;
-
-        // IT MAKES NO SENSE TO HAVE MORE THAN 1 RF_MANAGER
-    assert(obj_count == 1);
-
+#ifdef RF433RECV_CHANNEL_STATS
+    reset_channel_stats();
+#endif
+#ifdef SIMULATE_INTERRUPTS
+        // The signals of the test plan come in on the first channel.
+    if (!channel)
+        edge_source = timings_edge_source();
+#endif
 }
 
 RF_manager::RF_manager(byte arg_pin_input_num):
@@ -1010,14 +2411,92 @@ RF_manager::RF_manager(byte arg_pin_input_num):
 {
 }
 
-RF_manager::~RF_manager() { }
+    // Once destroyed, another RF_manager can be instanciated (useful to test
+    // or benchmark on the host, pointless on a board). The arena is reset
+    // when the last RF_manager gets destroyed.
+RF_manager::~RF_manager() {
+    inactivate_interrupts_handler();
+
+    recset_clear(&recsets[channel]);
+
+    Receiver *ptr_rec = head;
+    while (ptr_rec) {
+        Receiver *ptr_next = ptr_rec->get_next();
+        if (arena)
+            ptr_rec->~Receiver();
+        else
+            delete ptr_rec;
+        ptr_rec = ptr_next;
+    }
+    head = nullptr;
+    if (arena && obj_count == 1)
+        arena->reset();
+
+    cli();
+    sbuf[channel].clear();
+#ifdef RF433RECV_FRAME_QUEUE_NB
+    frame_queue[channel].clear();
+#endif
+    managers[channel] = nullptr;
+    sei();
+    --obj_count;
+}
+
+    // When an arena is set, receivers and callbacks are allocated in it,
+    // instead of on the heap.
+    // Must be called before registering receivers (with any RF_manager).
+void RF_manager::set_arena(RF433Arena *arg_arena) {
+    for (byte ch = 0; ch < RF433RECV_MAX_MANAGERS; ++ch)
+        assert(!managers[ch] || !managers[ch]->head);
+    arena = arg_arena;
+}
+
+    // Applies to the receivers registered afterwards (with the
+    // register_Receiver() that takes durations). tolerance is used with
+    // DecodeMood::CUSTOM only, and is a percentage in [1, 100].
+void RF_manager::set_decode_mood(DecodeMood mood, byte tolerance) {
+    assert(mood != DecodeMood::CUSTOM || (tolerance && tolerance <= 100));
+    decode_mood = mood;
+    decode_tolerance = tolerance;
+}
 
-void RF_manager::set_opt_wait_free_433(bool v, uint32_t timeout) {
+#ifdef RF433RECV_CALIBRATION
+    // Recalibrates all receivers (see Receiver::recalibrate()).
+    // Returns the number of receivers whose boundaries changed.
+byte RF_manager::recalibrate(byte min_codes) {
+    byte nb = 0;
+    for (Receiver *ptr_rec = head; ptr_rec; ptr_rec = ptr_rec->get_next()) {
+        if (ptr_rec->recalibrate(min_codes))
+            ++nb;
+    }
+    return nb;
+}
+#endif
+
+    // With v set, the callbacks are executed once the 433 MHz band is free
+    // (or timeout milliseconds later, if timeout is not 0).
+    // If async is false, do_events() waits for it (see wait_free_433()), and
+    // the receivers decode nothing meanwhile.
+    // If async is true, the occupancy of the band is tracked on every signal,
+    // and do_events() returns at once while the band is busy: the callbacks
+    // get executed by the first call to do_events() that finds it free.
+void RF_manager::set_opt_wait_free_433(bool v, uint32_t timeout,
+        bool async) {
     opt_wait_free_433_is_set = v;
     opt_wait_free_433_timeout = timeout;
+    cli();
+    opt_wait_free_433_async = v && async;
+#ifndef RF433RECV_CHANNEL_STATS
+        // Busy until proven otherwise, like in wait_free_433() (with the
+        // channel statistics, the occupancy is tracked all along).
+    occupancy_last16 = (uint16_t)0xffff;
+    occupancy_count_ok = 16;
+#endif
+    sei();
+    wait_free_433_is_pending = false;
 }
 
-Receiver* RF_manager::get_tail() {
+Receiver* RF_manager::get_tail() const {
     const Receiver* ptr_rec = head;
     if (ptr_rec) {
         while (ptr_rec->get_next())
@@ -1026,18 +2505,122 @@ Receiver* RF_manager::get_tail() {
     return (Receiver*)ptr_rec;
 }
 
-void RF_manager::register_Receiver(byte mod, uint16_t initseq,
+    // Allocates a callback, in the arena if one is set. Returns nullptr if the
+    // arena is full.
+static callback_t *new_callback(RF433Arena *arena,
+        void (*func)(const BitVector *recorded),
+        uint32_t min_delay_between_two_calls, const BitVector *pcode) {
+    callback_t *pcb = (arena ? new (*arena) callback_t : new callback_t);
+    if (!pcb)
+        return nullptr;
+    pcb->pcode = pcode;
+    pcb->func = func;
+    pcb->min_delay_between_two_calls = min_delay_between_two_calls;
+    pcb->last_trigger = 0;
+    pcb->next = nullptr;
+    return pcb;
+}
+
+    // Returns false if the receiver could not be registered, because the
+    // arena (if any) is full. The arena is then left as it was before the
+    // call.
+    // Past RF433RECV_MAX_RECEIVERS receivers, the receivers get registered
+    // all the same, but are processed on every signal (see "Receivers set").
+bool RF_manager::register_Receiver(byte mod, uint16_t initseq,
         uint16_t lo_prefix, uint16_t hi_prefix, uint16_t first_lo_ign,
         uint16_t lo_short, uint16_t lo_long, uint16_t hi_short,
         uint16_t hi_long, uint16_t lo_last, uint16_t sep, byte nb_bits,
         void (*func)(const BitVector *recorded),
         uint32_t min_delay_between_two_calls) {
+    const automat_args_t args = { mod, initseq, lo_prefix, hi_prefix,
+        first_lo_ign, lo_short, lo_long, hi_short, hi_long, lo_last, sep,
+        nb_bits, decode_mood, decode_tolerance };
+    return add_Receiver(nullptr, &args, func, min_delay_between_two_calls);
+}
+
+    // The decode mood is the one of args (not the one of set_decode_mood()).
+bool RF_manager::register_Receiver(const automat_args_t& args,
+        void (*func)(const BitVector *recorded),
+        uint32_t min_delay_between_two_calls) {
+    assert(automat_args_are_valid(args));
+    return add_Receiver(nullptr, &args, func, min_delay_between_two_calls);
+}
+
+    // pax is typically built at compile time with make_automat(). It is not
+    // copied, and not deleted when the receiver gets deleted.
+bool RF_manager::register_Receiver(const autoexec_t *pax,
+        void (*func)(const BitVector *recorded),
+        uint32_t min_delay_between_two_calls) {
+    assert(pax);
+    assert(pax->mod < ARRAYSZ(automat_descs));
+    return add_Receiver(pax, nullptr, func, min_delay_between_two_calls);
+}
+
+    // Exactly one of static_pax and args is not null: the receiver automat
+    // is either static_pax, or built from args.
+bool RF_manager::add_Receiver(const autoexec_t *static_pax,
+        const automat_args_t *args, void (*func)(const BitVector *recorded),
+        uint32_t min_delay_between_two_calls) {
+
+    const byte nb_bits =
+        (static_pax ? static_pax->values[AD_NB_BITS] : args->nb_bits);
+
+    Receiver *ptr_rec;
+    callback_t *pcb = nullptr;
+    if (arena) {
+        const size_t mark = arena->get_used();
+        const autoexec_t *dex = static_pax;
+        if (!dex) {
+            autoexec_t *pax = new (*arena) autoexec_t;
+            if (pax) {
+                build_automat(*args, pax);
+            }
+            dex = pax;
+        }
+        uint8_t *storage = (uint8_t*)arena->alloc((nb_bits + 7) >> 3);
+        BitVector *recorded =
+            (storage ? new (*arena) BitVector(nb_bits, storage) : nullptr);
+        ptr_rec = (dex && recorded ?
+                new (*arena) Receiver(dex, nb_bits, recorded) : nullptr);
+#ifdef SHARED_EDGE_CLASSIFICATION
+        uint16_t *table =
+            (ptr_rec ? (uint16_t*)arena->alloc(256 * sizeof(uint16_t))
+             : nullptr);
+        if (table)
+            ptr_rec->set_edge_class_table(table);
+        else
+            ptr_rec = nullptr;
+#endif
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        if (ptr_rec)
+            ptr_rec->set_channel(channel);
+#endif
+        if (ptr_rec && func) {
+            pcb = new_callback(arena, func, min_delay_between_two_calls,
+                    nullptr);
+        }
+        if (!ptr_rec || (func && !pcb)) {
+            arena->release_to(mark);
+            return false;
+        }
+        recset_add(&recsets[channel], ptr_rec);
+    } else {
+        const autoexec_t *dex = static_pax;
+        if (!dex) {
+            dex = build_automat(*args);
+        }
 
-    autoexec_t *dex = build_automat(mod, initseq, lo_prefix, hi_prefix,
-            first_lo_ign, lo_short, lo_long, hi_short, hi_long, lo_last, sep,
-            nb_bits);
+        ptr_rec = new Receiver(dex, nb_bits, nullptr, !static_pax);
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        ptr_rec->set_channel(channel);
+#endif
+        recset_add(&recsets[channel], ptr_rec);
+        if (func) {
+            pcb = new_callback(nullptr, func, min_delay_between_two_calls,
+                    nullptr);
+        }
+    }
 
-    Receiver *ptr_rec = new Receiver(dex, nb_bits);
     Receiver *tail = get_tail();
     if (!tail) {
         head = ptr_rec;
@@ -1045,11 +2628,22 @@ void RF_manager::register_Receiver(byte mod, uint16_t initseq,
         tail->attach(ptr_rec);
     }
 
-    if (func)
-        register_callback(func, min_delay_between_two_calls);
+#ifdef RF433RECV_CALIBRATION
+    if (!static_pax)
+        ptr_rec->set_calibration_args(*args);
+#endif
+
+    if (pcb)
+        ptr_rec->add_callback(pcb);
+
+    return true;
 }
 
 bool RF_manager::get_has_value() const {
+#ifdef RF433RECV_FRAME_QUEUE_NB
+    if (!frame_queue[channel].is_empty())
+        return true;
+#endif
     Receiver* ptr_rec = head;
     while (ptr_rec) {
         if (ptr_rec->get_has_value())
@@ -1074,65 +2668,311 @@ void RF_manager::activate_interrupts_handler() {
     if (handle_int_receive_interrupts_is_set)
         return;
 
-    handle_int_receive_interrupts_is_set = true;
+    handle_int_receive_interrupts_is_set = true;
+
+    edge_source->attach(channel_handler(channel));
+}
+
+void RF_manager::inactivate_interrupts_handler() {
+
+    if (!handle_int_receive_interrupts_is_set)
+        return;
+
+    edge_source->detach();
+
+    handle_int_receive_interrupts_is_set = false;
+}
+
+    // Where the edges come from, nullptr to get back to the default
+    // (GpioEdgeSource on the pin given to the constructor).
+void RF_manager::set_edge_source(EdgeSource *src) {
+    const bool is_set = handle_int_receive_interrupts_is_set;
+    inactivate_interrupts_handler();
+    edge_source = src ? src : &gpio_source;
+    if (is_set)
+        activate_interrupts_handler();
+}
+
+    // Signals dropped because the buffer was full.
+uint32_t RF_manager::get_dropped_signals() const {
+    cli();
+    uint32_t r = sbuf[channel].get_dropped();
+    sei();
+    return r;
+}
+
+    // Highest number of signals that have been waiting in the buffer at the
+    // same time.
+uint16_t RF_manager::get_signals_high_water_mark() const {
+    cli();
+    uint16_t r = sbuf[channel].get_high_water_mark();
+    sei();
+    return r;
+}
+
+void RF_manager::reset_signals_stats() {
+    cli();
+    sbuf[channel].reset_stats();
+#ifdef RF433RECV_FRAME_QUEUE_NB
+    frame_queue[channel].reset_stats();
+#endif
+    sei();
+}
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+
+    // Codes that could not be queued because the queue was full (see "Frame
+    // queue" about what happens then).
+uint32_t RF_manager::get_frame_queue_overflows() const {
+    cli();
+    uint32_t r = frame_queue[channel].get_dropped();
+    sei();
+    return r;
+}
+
+    // Highest number of codes that have been waiting in the queue at the same
+    // time.
+uint16_t RF_manager::get_frames_high_water_mark() const {
+    cli();
+    uint16_t r = frame_queue[channel].get_high_water_mark();
+    sei();
+    return r;
+}
 
-#ifndef SIMULATE_INTERRUPTS
-    attachInterrupt(int_num, &handle_int_receive, CHANGE);
 #endif
 
+    // When deferred decoding is set, the interrupt handler only records
+    // signals in the buffer, and the decoding takes place in do_events() (or
+    // wait_value_available()).
+    // This keeps the interrupt handler short, to the cost of a bigger buffer:
+    // define BUFFER_SIGNALS_NB so that it can hold the signals received
+    // between two calls to do_events(). See get_dropped_signals() to check it
+    // is big enough.
+void RF_manager::set_deferred_decoding(bool val) {
+    cli();
+    deferred_decoding = val;
+    sei();
 }
 
-void RF_manager::inactivate_interrupts_handler() {
+    // Decodes the signals waiting in the buffer, until a receiver has a
+    // value (then returns true) or the buffer is empty (then returns false).
+bool RF_manager::decode_buffered_signals() {
+    sbuf_entry_t entry;
+    while (sbuf[channel].pop(&entry)) {
+        if (process_signal_all_receivers(&recsets[channel],
+                    entry.compact_signal_duration, entry.signal_val)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    if (!handle_int_receive_interrupts_is_set)
-        return;
+    // Decodes a batch of signals, one receiver after the other (instead of
+    // one signal after the other, as done by decode_buffered_signals() and
+    // replay()), see Receiver::process_signals().
+    // The idle receivers (status 0) that no high signal of the batch can wake
+    // up are not even looked at.
+    // Callbacks are executed as soon as a receiver has a value, so that it
+    // can decode the remaining signals (with the frame queue, once the batch
+    // is decoded, unless the queue gets full). As a result, the callbacks of
+    // two receivers that get a value within the same batch are executed in
+    // the order of registration, not in the order of reception.
+    // Like replay(), meant to be called while the interrupt handler is
+    // inactive, or in deferred decoding mode.
+void RF_manager::process_signals(const sbuf_entry_t *edges, size_t n) {
+    duration_t max_hi = 0;
+    bool has_hi = false;
+    for (size_t i = 0; i < n; ++i) {
+        if (edges[i].signal_val) {
+            has_hi = true;
+            if (edges[i].compact_signal_duration > max_hi)
+                max_hi = edges[i].compact_signal_duration;
+        }
+    }
 
-#ifndef SIMULATE_INTERRUPTS
-    detachInterrupt(int_num);
-#endif
+        // The receivers of the set, then the ones past it (see "Receivers
+        // set"), in the order of registration.
+    recset_t *rs = &recsets[channel];
+    uint16_t idx = 0;
+    for (Receiver *ptr_rec = head; ptr_rec;
+            ptr_rec = ptr_rec->get_next(), ++idx) {
+        if (!ptr_rec->get_status()
+                && (!has_hi || ptr_rec->get_initseq_inf() > max_hi)) {
+            continue;
+        }
 
-    handle_int_receive_interrupts_is_set = false;
+        size_t i = 0;
+        while (i < n) {
+            const size_t nb = ptr_rec->process_signals(edges + i, n - i);
+            if (!nb)
+                break;
+            i += nb;
+            if (ptr_rec->get_has_value())
+                execute_receivers_callbacks();
+        }
+        if (idx < rs->nb)
+            recset_update(rs, idx);
+    }
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        // The codes queued by the receivers above
+    execute_receivers_callbacks();
+#endif
 }
 
 void RF_manager::wait_value_available() {
     activate_interrupts_handler();
     while (!get_has_value()) {
+        if (deferred_decoding && decode_buffered_signals())
+            break;
         delay(1);
 #ifdef SIMULATE_INTERRUPTS
         handle_int_receive();
 #endif
     }
     inactivate_interrupts_handler();
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        // So that get_receiver_that_has_a_value() finds the first code
+        // received.
+    rf_frame_t frame;
+    if (!get_receiver_that_has_a_value() && frame_queue[channel].pop(&frame))
+        frame.rec->restore_value(&frame);
+#endif
 }
 
 void RF_manager::do_events() {
+#ifdef RF433RECV_CHANNEL_STATS
+    update_channel_stats();
+#endif
+    execute_receivers_callbacks();
+
+    if (!deferred_decoding)
+        return;
+
+    if (first_decoder_that_has_a_value_resets_others) {
+            // A receiver that gets a value resets the others, that must
+            // therefore process signals at the same pace.
+            // The callbacks are executed each time a receiver has a value:
+            // until then, a receiver that has a value does not decode
+            // anything.
+        while (decode_buffered_signals())
+            execute_receivers_callbacks();
+    } else {
+        const sbuf_entry_t *edges;
+        size_t n;
+        while ((n = sbuf[channel].peek(&edges)) != 0) {
+            process_signals(edges, n);
+            sbuf[channel].consume(n);
+        }
+    }
+}
+
+    // What is done before executing the callbacks of a value, once per call
+    // to execute_receivers_callbacks().
+void RF_manager::before_callbacks(bool *deja_vu,
+        bool *reactivate_interrupts_handler_in_the_end,
+        bool *has_waited_free_433) {
+
+    if (inactivate_interrupts_handler_when_a_value_has_been_received
+            && !*deja_vu) {
+        *deja_vu = true;
+        *reactivate_interrupts_handler_in_the_end =
+            handle_int_receive_interrupts_is_set;
+        inactivate_interrupts_handler();
+    }
+
+    if (opt_wait_free_433_is_set && !opt_wait_free_433_async) {
+        if (!*has_waited_free_433) {
+            wait_free_433();
+            *has_waited_free_433 = true;
+        }
+    }
+}
+
+#if RF433RECV_MAX_MANAGERS > 1
+    // The last codes whose callbacks got executed, see is_duplicate().
+    // More than one, as a signal can be decoded by several receivers of the
+    // same RF_manager, each giving its own code.
+#define DEDUP_NB 4
+struct dedup_entry_t {
+    InlineBitVector<255> code;
+    byte channel;
+    uint32_t t;
+};
+static dedup_entry_t dedup_entries[DEDUP_NB];
+static byte dedup_next = 0;
+#endif
+
+    // With a dedup delay set (see set_dedup_delay()), returns true if code is
+    // one of the last codes whose callbacks got executed by another
+    // RF_manager, less than the delay ago: the same code, received through
+    // two antennas, gets executed once.
+    // Otherwise, returns false and code is recorded as the last code.
+bool RF_manager::is_duplicate(const BitVector *code) const {
+#if RF433RECV_MAX_MANAGERS > 1
+    if (!dedup_delay)
+        return false;
+
+    const uint32_t t = millis();
+    for (byte i = 0; i < DEDUP_NB; ++i) {
+        const dedup_entry_t *e = &dedup_entries[i];
+        if (e->code.get_nb_bits() && e->channel != channel
+                && t - e->t < dedup_delay && !e->code.cmp(code)) {
+            return true;
+        }
+    }
+
+    dedup_entry_t *e = &dedup_entries[dedup_next];
+    dedup_next = (dedup_next + 1) % DEDUP_NB;
+    e->code.load_from(code);
+    e->channel = channel;
+    e->t = t;
+#endif
+    return false;
+}
+
+void RF_manager::execute_receivers_callbacks() {
+    if (opt_wait_free_433_async && !poll_free_433())
+        return;
+
     bool has_waited_free_433 = false;
 
     bool deja_vu = false;
     bool reactivate_interrupts_handler_in_the_end = false;
 
     byte exec_count = 0;
-    Receiver* ptr_rec = head;
-    while (ptr_rec) {
-        if (ptr_rec->get_has_value()) {
-
-            if (inactivate_interrupts_handler_when_a_value_has_been_received
-                    && !deja_vu) {
-                deja_vu = true;
-                reactivate_interrupts_handler_in_the_end =
-                    handle_int_receive_interrupts_is_set;
-                inactivate_interrupts_handler();
-            }
 
-            if (opt_wait_free_433_is_set) {
-                if (!has_waited_free_433) {
-                    wait_free_433();
-                    has_waited_free_433 = true;
-                }
-            }
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        // The queued codes got received before the ones kept by receivers
+        // (these ones got kept because the queue was full).
+    rf_frame_t frame;
+    while (!(first_decoder_that_has_a_value_resets_others && exec_count)
+            && frame_queue[channel].pop(&frame)) {
+        InlineBitVector<RF433RECV_FRAME_MAX_BITS> code;
+        code.load_bits(frame.nb_bits, frame.bits);
+        if (is_duplicate(&code))
+            continue;
+        before_callbacks(&deja_vu, &reactivate_interrupts_handler_in_the_end,
+                &has_waited_free_433);
+        code_timestamp = frame.t;
+        exec_count += frame.rec->execute_callbacks(&code, frame.t);
+    }
+#endif
 
+    Receiver* ptr_rec =
+        (first_decoder_that_has_a_value_resets_others && exec_count ?
+         nullptr : head);
+    while (ptr_rec) {
+        if (ptr_rec->get_has_value()
+                && is_duplicate(ptr_rec->get_recorded())) {
+            ptr_rec->reset();
+        } else if (ptr_rec->get_has_value()) {
+            before_callbacks(&deja_vu,
+                    &reactivate_interrupts_handler_in_the_end,
+                    &has_waited_free_433);
+#ifdef RF433RECV_FRAME_QUEUE_NB
+            code_timestamp = ptr_rec->get_value_t();
+#endif
             exec_count += ptr_rec->execute_callbacks();
-
         }
         if (first_decoder_that_has_a_value_resets_others && exec_count) {
             ptr_rec = nullptr;
@@ -1150,6 +2990,11 @@ void RF_manager::do_events() {
             ptr_rec->reset();
             ptr_rec = ptr_rec->get_next();
         }
+#ifdef RF433RECV_FRAME_QUEUE_NB
+            // The codes queued meanwhile go away, too.
+        while (frame_queue[channel].pop(&frame))
+            ;
+#endif
 
         sei();
 
@@ -1183,21 +3028,137 @@ void RF_manager::do_events() {
     }
 }
 
-void RF_manager::register_callback(void (*func)(const BitVector *recorded),
+    // Feed recorded durations to the registered receivers, as fast as
+    // possible (no interrupt, no waiting).
+    // durations[0] is the duration of a signal of level first_level, then
+    // levels alternate: durations[1] has level !first_level, and so on.
+    // Callbacks are executed (by do_events()) as soon as a receiver has a
+    // value, so that no code gets lost, whatever the number of codes found in
+    // durations.
+    // Meant to be called while the interrupt handler is inactive: the
+    // receivers would otherwise be fed with two different sources.
+    // A long recording can be replayed in successive calls, as long as
+    // first_level is updated accordingly.
+void RF_manager::replay(const uint16_t *durations, size_t n,
+        byte first_level) {
+    byte signal_val = !first_level;
+    for (size_t i = 0; i < n; ++i) {
+            // Like in handle_int_receive(), the level given alongside a
+            // duration is the level of the signal that *follows* it.
+#ifdef RF433RECV_DISCOVERY
+        const sbuf_entry_t entry = { signal_val, compact(durations[i]) };
+        discovery_record(channel, entry);
+#endif
+        ih_track_occupancy(durations[i]);
+            // While callbacks wait for the band to be free (see
+            // set_opt_wait_free_433()), do_events() is called on every signal,
+            // as loop() would do.
+        if (process_signal_all_receivers(&recsets[channel],
+                    compact(durations[i]), signal_val)
+                || wait_free_433_is_pending) {
+            do_events();
+        }
+        signal_val = !signal_val;
+    }
+}
+
+#ifdef RF433RECV_DISCOVERY
+    // Starts recording the signals of this RF_manager (nb_signals of them), to
+    // work out a protocol from them, see discover().
+    // The buffer is allocated on the heap (nb_signals x 2 bytes with 8-bit
+    // durations), until discover() succeeds or stop_discovery() gets called.
+    // Returns false if it can't be allocated.
+    // Only one RF_manager can discover at a time: call stop_discovery() (or
+    // have discover() succeed) before starting it on another one.
+bool RF_manager::start_discovery(uint16_t nb_signals) {
+    assert(!discovery_buf || discovery_channel == channel);
+    stop_discovery();
+    assert(nb_signals);
+    sbuf_entry_t *buf =
+        (sbuf_entry_t*)malloc(nb_signals * sizeof(sbuf_entry_t));
+    if (!buf)
+        return false;
+    cli();
+    discovery_buf = buf;
+    discovery_len = 0;
+    discovery_size = nb_signals;
+    discovery_channel = channel;
+    sei();
+    return true;
+}
+
+void RF_manager::stop_discovery() {
+    cli();
+    sbuf_entry_t *buf = discovery_buf;
+    discovery_buf = nullptr;
+    discovery_size = 0;
+    discovery_len = 0;
+    sei();
+    if (buf)
+        free(buf);
+}
+
+    // To be called regularly once discovery is started (like do_events()).
+    // Once the signals are recorded, works out the arguments of
+    // register_Receiver() from them (see "Discovery" above), and returns true
+    // if a protocol is found (args is then set, and discovery stops).
+    // Otherwise, starts recording again and returns false.
+    // Takes some time (each candidate protocol gets tried on the signals
+    // recorded), during which the signals received are not recorded.
+bool RF_manager::discover(automat_args_t *args) {
+    assert(args);
+    cli();
+    const bool is_full = discovery_size && discovery_len >= discovery_size;
+    sei();
+    if (!is_full)
+        return false;
+
+    if (discovery_analyze(discovery_buf, discovery_size, args)) {
+        stop_discovery();
+        return true;
+    }
+    cli();
+    discovery_len = 0;
+    sei();
+    return false;
+}
+#endif
+
+    // Returns false if the arena (if any) is full.
+bool RF_manager::register_callback(void (*func)(const BitVector *recorded),
         uint32_t min_delay_between_two_calls, const BitVector *pcode) {
 
     Receiver *tail = get_tail();
     assert(tail); // A bit brutal... caller should know that register_callback
                   // can be done only after registering a Receiver.
 
-    callback_t *pcb = new callback_t;
-    pcb->pcode = pcode;
-    pcb->func = func;
-    pcb->min_delay_between_two_calls = min_delay_between_two_calls;
-    pcb->last_trigger = 0;
-    pcb->next = nullptr;
+    callback_t *pcb = new_callback(arena, func, min_delay_between_two_calls,
+            pcode);
+    if (!pcb)
+        return false;
 
     tail->add_callback(pcb);
+    return true;
+}
+
+    // The 433 MHz band is deemed busy as long as at least 12 of the last 16
+    // durations are in the interval [200, 25000] (last16 has one bit per
+    // duration, set if it is in the interval, and count_ok is the number of
+    // bits set).
+#define OCCUPANCY_BUSY_COUNT 12
+
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static inline void occupancy_add(volatile uint16_t *last16,
+        volatile short *count_ok, unsigned long d) {
+    short new_bit = (d >= 200 && d <= 25000);
+    short old_bit = !!(*last16 & 0x8000);
+    *last16 <<= 1;
+    *last16 |= new_bit;
+
+    *count_ok += new_bit;
+    *count_ok -= old_bit;
 }
 
 #if defined(ESP8266)
@@ -1213,13 +3174,120 @@ void RF_manager::ih_handle_interrupt_wait_free() {
     if (d > 65535)
         d = 65535;
 
-    short new_bit = (d >= 200 && d <= 25000);
-    short old_bit = !!(IH_wait_free_last16 & 0x8000);
-    IH_wait_free_last16 <<= 1;
-    IH_wait_free_last16 |= new_bit;
+    occupancy_add(&IH_wait_free_last16, &IH_wait_free_count_ok, d);
+}
+
+    // Called on every signal (by the interrupt handler, or replay()), so
+    // that the occupancy of the band is known at any time, see
+    // set_opt_wait_free_433().
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+void RF_manager::ih_track_occupancy(uint16_t d) {
+#ifdef RF433RECV_CHANNEL_STATS
+    occupancy_add(&occupancy_last16, &occupancy_count_ok, d);
+    channel_stats_t *st = &stats_current[channel];
+    ++st->edges;
+    st->plausible += (occupancy_last16 & 1);
+    if (occupancy_count_ok >= OCCUPANCY_BUSY_COUNT)
+        st->busy_us += d;
+#else
+    if (opt_wait_free_433_async)
+        occupancy_add(&occupancy_last16, &occupancy_count_ok, d);
+#endif
+}
+
+    // Returns true if the band is busy, according to the last 16 signals
+    // (see wait_free_433()). Meaningful only if the occupancy gets tracked,
+    // that is, with RF433RECV_CHANNEL_STATS defined, or with
+    // set_opt_wait_free_433() called with async set.
+bool RF_manager::get_band_is_busy() const {
+    cli();
+    const short count_ok = occupancy_count_ok;
+    sei();
+    return count_ok >= OCCUPANCY_BUSY_COUNT;
+}
+
+#ifdef RF433RECV_CHANNEL_STATS
+    // Closes the window being recorded if it lasted
+    // RF433RECV_STATS_WINDOW_MS. Called by do_events() and
+    // get_channel_stats().
+void RF_manager::update_channel_stats() {
+    const uint32_t t = millis();
+    if (t - stats_t0[channel] < RF433RECV_STATS_WINDOW_MS)
+        return;
+
+    cli();
+    channel_stats_t st = stats_current[channel];
+    memset(&stats_current[channel], 0, sizeof(stats_current[channel]));
+    sei();
+
+    st.duration_ms = t - stats_t0[channel];
+    stats_t0[channel] = t;
+    stats_windows[channel][stats_next[channel]] = st;
+    stats_next[channel] =
+        (stats_next[channel] + 1) % RF433RECV_STATS_NB_WINDOWS;
+    if (stats_nb[channel] < RF433RECV_STATS_NB_WINDOWS)
+        ++stats_nb[channel];
+}
 
-    IH_wait_free_count_ok += new_bit;
-    IH_wait_free_count_ok -= old_bit;
+    // Sets st to the sum of the last nb_windows windows recorded (sliding
+    // window of nb_windows x RF433RECV_STATS_WINDOW_MS milliseconds), and
+    // returns the number of windows summed (less than nb_windows if less got
+    // recorded so far).
+    // do_events() must be called regularly, as it is the one that closes the
+    // windows.
+byte RF_manager::get_channel_stats(channel_stats_t *st, byte nb_windows) {
+    assert(st);
+    update_channel_stats();
+
+    memset(st, 0, sizeof(*st));
+    if (nb_windows > stats_nb[channel])
+        nb_windows = stats_nb[channel];
+    byte idx = stats_next[channel];
+    for (byte i = 0; i < nb_windows; ++i) {
+        idx = (idx ? idx : RF433RECV_STATS_NB_WINDOWS) - 1;
+        const channel_stats_t *w = &stats_windows[channel][idx];
+        st->duration_ms += w->duration_ms;
+        st->edges += w->edges;
+        st->plausible += w->plausible;
+        st->busy_us += w->busy_us;
+    }
+    return nb_windows;
+}
+
+void RF_manager::reset_channel_stats() {
+    cli();
+    memset(&stats_current[channel], 0, sizeof(stats_current[channel]));
+    sei();
+    stats_t0[channel] = millis();
+    stats_next[channel] = 0;
+    stats_nb[channel] = 0;
+}
+#endif
+
+    // The non-blocking flavor of wait_free_433(), called by
+    // execute_receivers_callbacks(): returns false while the callbacks must
+    // wait (a value is available and the band is busy, the timeout not being
+    // reached).
+bool RF_manager::poll_free_433() {
+    if (!wait_free_433_is_pending) {
+        if (!get_has_value())
+            return true;
+        wait_free_433_is_pending = true;
+        wait_free_433_t0 = millis();
+    }
+
+    cli();
+    const short count_ok = occupancy_count_ok;
+    sei();
+    if (count_ok >= OCCUPANCY_BUSY_COUNT && (!opt_wait_free_433_timeout
+                || millis() - wait_free_433_t0 < opt_wait_free_433_timeout)) {
+        return false;
+    }
+
+    wait_free_433_is_pending = false;
+    return true;
 }
 
 void RF_manager::wait_free_433() {
@@ -1236,9 +3304,7 @@ void RF_manager::wait_free_433() {
 
     attachInterrupt(int_num, &ih_handle_interrupt_wait_free, CHANGE);
 
-        // 75% of the last 16 durations must be in the interval [200, 25000]
-        // (that is, 12 'ok' out of 16 in total).
-    while (IH_wait_free_count_ok >= 12 &&
+    while (IH_wait_free_count_ok >= OCCUPANCY_BUSY_COUNT &&
               (!opt_wait_free_433_timeout
                || (millis() - t0 < opt_wait_free_433_timeout)
               )
@@ -1252,9 +3318,12 @@ void RF_manager::wait_free_433() {
         activate_interrupts_handler();
 }
 
-byte RF_manager::pin_input_num = 255;
-Receiver* RF_manager::head = nullptr;
+RF433Arena* RF_manager::arena = nullptr;
 byte RF_manager::obj_count = 0;
+uint32_t RF_manager::dedup_delay = 0;
+#ifdef RF433RECV_FRAME_QUEUE_NB
+unsigned long RF_manager::code_timestamp = 0;
+#endif
 
 volatile short RF_manager::IH_wait_free_count_ok;
 volatile uint16_t RF_manager::IH_wait_free_last16;
@@ -1846,88 +3915,350 @@ size_t timings_index = 0;
 bool has_read_all_timings() { return timings_index >= timings_len; }
 #endif
 
-static bool handle_int_busy = false;
 
-struct sbuf_entry_t {
-    byte signal_val;
-    duration_t compact_signal_duration;
-};
-static sbuf_entry_t sbuf[BUFFER_SIGNALS_NB];
-    // Keep in mind, we can't manage more than 128 values in the buffer (biggest
-    // power of 2 that fits in a byte).
-static byte sbuf_read_head = 0;
-static byte sbuf_write_head = 0;
+// * ************ *************************************************************
+// * Edge sources *************************************************************
+// * ************ *************************************************************
+
+// An EdgeSource is what feeds a channel (see "Channels" below): the decoding
+// is the same whatever the source, be it a pin change interrupt
+// (GpioEdgeSource), the input capture unit of Timer1 (InputCaptureEdgeSource),
+// the timings above (test plan), or a capture file (extras/host).
+
+    // With LevelMode::TOGGLE, the pin is read at least every GPIO_RESYNC_EDGES
+    // edges.
+#define GPIO_RESYNC_EDGES 64
+
+GpioEdgeSource::GpioEdgeSource(byte arg_pin, byte arg_int_num):
+        pin(arg_pin),
+        int_num(arg_int_num),
+        last_t(0),
+        level_mode(LevelMode::READ),
+        resync_duration(0),
+        level(0),
+        edges_before_resync(0),
+        level_desyncs(0) {
+#ifdef __AVR__
+    in_reg = portInputRegister(digitalPinToPort(pin));
+    in_mask = digitalPinToBitMask(pin);
+#endif
+}
+
+    // To be called while the interrupts handler is inactive.
+void GpioEdgeSource::set_level_mode(LevelMode mode,
+        uint16_t arg_resync_duration) {
+    level_mode = mode;
+    resync_duration = arg_resync_duration;
+}
+
+    // Desynchronizations caught up with LevelMode::TOGGLE (the level read
+    // was not the one expected).
+uint32_t GpioEdgeSource::get_level_desyncs() const {
+    cli();
+    uint32_t r = level_desyncs;
+    sei();
+    return r;
+}
 
 #if defined(ESP8266)
 IRAM_ATTR
 #endif
-void handle_int_receive() {
-    static unsigned long last_t = 0;
+inline byte GpioEdgeSource::read_pin() const {
+#ifdef __AVR__
+    return (*in_reg & in_mask ? 1 : 0);
+#else
+    return (digitalRead(pin) == HIGH ? 1 : 0);
+#endif
+}
 
+void GpioEdgeSource::attach(rf_handler_t handler) {
+        // The level before the first edge
+    level = read_pin();
+    edges_before_resync = GPIO_RESYNC_EDGES;
+        // The first duration is measured from now on.
+    last_t = micros();
+    attachInterrupt(int_num, handler, CHANGE);
+}
+
+void GpioEdgeSource::detach() {
+    detachInterrupt(int_num);
+}
+
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+bool GpioEdgeSource::read_edge(uint16_t *duration, byte *arg_level) {
     const unsigned long t = micros();
-    unsigned long signal_duration = t - last_t;
+    const unsigned long d = t - last_t;
     last_t = t;
+    *duration = (d > 65535 ? 65535 : d);
 
-#ifdef SIMULATE_INTERRUPTS
-    if (timings_index < timings_len) {
-        signal_duration = pgm_read_word(&timings[timings_index]);
+    if (level_mode == LevelMode::READ) {
+        *arg_level = read_pin();
+        return true;
+    }
 
-        timings_index++;
-    } else {
-        return;
+    level = !level;
+    if (d >= resync_duration || !--edges_before_resync) {
+        edges_before_resync = GPIO_RESYNC_EDGES;
+        const byte actual = read_pin();
+        if (actual != level) {
+            ++level_desyncs;
+            level = actual;
+        }
     }
+    *arg_level = level;
+    return true;
+}
+
+#ifdef RF433RECV_INPUT_CAPTURE
+
+#if F_CPU < 8000000UL
+#error "RF433RECV_INPUT_CAPTURE requires F_CPU >= 8 MHz"
+#endif
+
+    // The handler given to attach(), called by the capture interrupt
+static rf_handler_t icp_handler = nullptr;
+    // Overflows of Timer1, the high 16 bits of the timestamps
+static volatile uint16_t icp_overflows = 0;
+
+ISR(TIMER1_CAPT_vect) {
+    if (icp_handler)
+        icp_handler();
+}
+
+ISR(TIMER1_OVF_vect) {
+    ++icp_overflows;
+}
+
+    // Timer1 runs freely at F_CPU / 8, and captures the next edge (the noise
+    // canceler requires 4 identical samples, that is, adds 0.5 us).
+void InputCaptureEdgeSource::attach(rf_handler_t handler) {
+    cli();
+    saved_tccr1a = TCCR1A;
+    saved_tccr1b = TCCR1B;
+    saved_timsk1 = TIMSK1;
+    icp_handler = handler;
+    TCCR1A = 0;
+    TCCR1B = _BV(ICNC1) | _BV(ICES1) | _BV(CS11);
+    TIFR1 = _BV(ICF1) | _BV(TOV1);
+    TIMSK1 = _BV(ICIE1) | _BV(TOIE1);
+    sei();
+}
+
+void InputCaptureEdgeSource::detach() {
+    cli();
+    TIMSK1 = saved_timsk1;
+    TCCR1A = saved_tccr1a;
+    TCCR1B = saved_tccr1b;
+    icp_handler = nullptr;
+    sei();
+}
+
+bool InputCaptureEdgeSource::read_edge(uint16_t *duration, byte *level) {
+    const uint16_t icr = ICR1;
+        // The edge captured is the one ICES1 selects (1: rising). The next
+        // one is the other way round.
+    *level = (TCCR1B & _BV(ICES1) ? 1 : 0);
+    TCCR1B ^= _BV(ICES1);
+        // Changing the edge can set the capture flag.
+    TIFR1 = _BV(ICF1);
+
+    uint16_t ovf = icp_overflows;
+        // An overflow pending while the capture occurred in the first half of
+        // the period: the overflow came first.
+    if ((TIFR1 & _BV(TOV1)) && icr < 0x8000)
+        ++ovf;
+    const uint32_t ticks = ((uint32_t)ovf << 16) | icr;
+    uint32_t d = (ticks - last_ticks) / (F_CPU / 8000000UL);
+    last_ticks = ticks;
+    *duration = (d > 65535 ? 65535 : d);
+    return true;
+}
+
+#endif // RF433RECV_INPUT_CAPTURE
+
+#ifdef SIMULATE_INTERRUPTS
+    // The timings above, one per call to handle_int_receive().
+class TimingsEdgeSource: public EdgeSource {
+    public:
+        void attach(rf_handler_t) override { }
+        void detach() override { }
+        bool read_edge(uint16_t *duration, byte *level) override {
+            if (timings_index >= timings_len)
+                return false;
+            *duration = pgm_read_word(&timings[timings_index]);
+            timings_index++;
+            *level = !(timings_index % 2);
 #ifdef DEBUG_AUTOMAT
-    dbg("--");
+            dbg("--");
 #endif
+            return true;
+        }
+};
+
+static EdgeSource *timings_edge_source() {
+    static TimingsEdgeSource src;
+    return &src;
+}
 #endif
 
-    bool was_handle_int_busy = handle_int_busy;
-    handle_int_busy = true;
 
-#ifdef SIMULATE_INTERRUPTS
-    byte signal_val = !(timings_index % 2);
-#else
-    byte signal_val =
-        (digitalRead(RF_manager::get_pin_input_num()) == HIGH ? 1 : 0);
+// * ******** *****************************************************************
+// * Channels *****************************************************************
+// * ******** *****************************************************************
+
+// Each RF_manager is a channel (up to RF433RECV_MAX_MANAGERS), made of an
+// input pin, an interrupt handler (handle_int_receive_ch<CH>()), a buffer of
+// signals (sbuf[CH]), a set of receivers (recsets[CH]) and, with the frame
+// queue, a queue of codes (frame_queue[CH]).
+// The decoding code is shared: when a signal comes in on a channel while the
+// signals of another one are being decoded (handle_int_busy set), it is only
+// recorded, and the interrupt handler that is decoding decodes it, too, before
+// it returns. As a result, signals get decoded one at a time, whatever the
+// number of channels (which is what the frame queues need).
+// The interrupt handler of a channel gets the signals from the EdgeSource of
+// its RF_manager (see "Edge sources" above).
+// The first channel's interrupt handler is handle_int_receive(), the one used
+// by the test plan with SIMULATE_INTERRUPTS.
+
+    // Set while signals are being decoded by an interrupt handler.
+static bool handle_int_busy = false;
+
+    // Returns true if at least one receiver got a value with this signal
+    // (meaning, RF_manager::do_events() has something to do).
+    // See "Receivers set" about which receivers get processed.
+#if defined(ESP8266)
+IRAM_ATTR
 #endif
+static bool process_signal_all_receivers(recset_t *rs,
+        duration_t compact_signal_duration, byte signal_val) {
+    bool ret = false;
+
+        // The receivers woken up below must not be processed twice.
+    recset_word_t active[RECSET_NB_WORDS];
+    for (byte w = 0; w < RECSET_NB_WORDS; ++w)
+        active[w] = rs->active[w];
+
+    if (signal_val) {
+        for (byte i = 0; i < rs->nb
+                && rs->initseq_inf[i] <= compact_signal_duration; ++i) {
+            const byte idx = rs->by_initseq[i];
+            const recset_word_t bit =
+                (recset_word_t)1 << (idx % RECSET_WORD_BITS);
+                // A receiver in status 0 can't have a value.
+            if (!(active[idx / RECSET_WORD_BITS] & bit)
+                    && !rs->receivers[idx]->get_status()) {
+                ret = recset_process(rs, idx, compact_signal_duration,
+                        signal_val) || ret;
+            }
+        }
+    }
 
-    duration_t compact_signal_duration = compact(signal_duration);
+    for (byte w = 0; w < RECSET_NB_WORDS; ++w) {
+        recset_word_t m = active[w];
+        while (m) {
+            const byte idx = w * RECSET_WORD_BITS + recset_ctz(m);
+            m &= m - 1;
+            ret = recset_process(rs, idx, compact_signal_duration, signal_val)
+                || ret;
+        }
+    }
 
-    byte next_sbuf_write_head = (sbuf_write_head + 1) & BUFFER_SIGNALS_MASK;
-    if (next_sbuf_write_head == sbuf_read_head) {
-            // There is a decision to take here: would we run out of space in
-            // the buffer, we can either stop writing new signals, or, skip a
-            // previously recorded signal.
-            // For now, we decide to skip previously recorded signals.
-        sbuf_read_head = (sbuf_read_head + 1) & BUFFER_SIGNALS_MASK;
+    for (Receiver *ptr_rec = rs->overflow; ptr_rec;
+            ptr_rec = ptr_rec->get_next()) {
+        ret = recset_process_receiver(ptr_rec, compact_signal_duration,
+                signal_val) || ret;
     }
-    sbuf[sbuf_write_head].signal_val = signal_val;
-    sbuf[sbuf_write_head].compact_signal_duration = compact_signal_duration;
-    sbuf_write_head = next_sbuf_write_head;
 
-    if (!was_handle_int_busy) {
-        while (sbuf_read_head != sbuf_write_head) {
-            signal_val = sbuf[sbuf_read_head].signal_val;
-            compact_signal_duration =
-                sbuf[sbuf_read_head].compact_signal_duration;
+    return ret;
+}
 
-            sei();
+    // The channels whose signals are decoded by the interrupt handler
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static inline bool channel_decodes_in_ih(byte ch) {
+    return managers[ch] && !managers[ch]->get_deferred_decoding();
+}
+
+    // Decodes the signals waiting in the buffers of the channels that are not
+    // in deferred decoding mode.
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static void decode_channels_signals() {
+    for (byte ch = 0; ch < RF433RECV_MAX_MANAGERS; ++ch) {
+        if (!channel_decodes_in_ih(ch))
+            continue;
+        sbuf_entry_t entry;
+        while (sbuf[ch].pop(&entry)) {
+            process_signal_all_receivers(&recsets[ch],
+                    entry.compact_signal_duration, entry.signal_val);
+        }
+    }
+}
 
-            Receiver *ptr_rec = RF_manager::get_head();
-            while (ptr_rec) {
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static bool channels_signals_are_decoded() {
+    for (byte ch = 0; ch < RF433RECV_MAX_MANAGERS; ++ch) {
+        if (channel_decodes_in_ih(ch) && !sbuf[ch].is_empty())
+            return false;
+    }
+    return true;
+}
 
-#ifdef DEBUG_AUTOMAT
-                dbgf("\nptr_rec = %lu", (unsigned long)ptr_rec);
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+static void handle_int_receive_channel(byte ch) {
+#ifdef DEBUG_EXEC_TIMES
+    const unsigned long t = micros();
 #endif
 
-                ptr_rec->process_signal(compact_signal_duration, signal_val);
-                ptr_rec = ptr_rec->get_next();
-            }
+    uint16_t signal_duration;
+    byte signal_val;
+    if (!managers[ch]
+            || !managers[ch]->get_edge_source()->read_edge(&signal_duration,
+                &signal_val)) {
+        return;
+    }
+    managers[ch]->ih_track_occupancy(signal_duration);
+
+    const bool was_handle_int_busy = handle_int_busy;
+    handle_int_busy = true;
+
+    sbuf_entry_t entry;
+    entry.signal_val = signal_val;
+    entry.compact_signal_duration = compact(signal_duration);
+
+#ifdef RF433RECV_DISCOVERY
+    discovery_record(ch, entry);
+#endif
 
+        // There is a decision to take here: would we run out of space in the
+        // buffer, we can either stop writing new signals, or, skip a
+        // previously recorded signal.
+        // The latter would mean updating the read head, that belongs to the
+        // code reading the buffer: we stop writing new signals (they are
+        // counted, see RF_manager::get_dropped_signals()).
+    sbuf[ch].push(entry);
+
+    if (!was_handle_int_busy && channel_decodes_in_ih(ch)) {
+            // The buffers are checked one last time with interrupts disabled,
+            // so that no signal is left behind when handle_int_busy gets
+            // reset.
+        do {
+            sei();
+            decode_channels_signals();
             cli();
-            sbuf_read_head = (sbuf_read_head + 1) & BUFFER_SIGNALS_MASK;
-        }
+        } while (!channels_signals_are_decoded());
+        handle_int_busy = false;
         sei();
+    } else {
+        handle_int_busy = was_handle_int_busy;
     }
 
 #ifdef DEBUG_EXEC_TIMES
@@ -1936,8 +4267,51 @@ void handle_int_receive() {
     measure_time_r53.add(d);
     measure_time_r59.add(d);
 #endif
+}
+
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+void handle_int_receive() {
+    handle_int_receive_channel(0);
+}
+
+template<byte CH>
+#if defined(ESP8266)
+IRAM_ATTR
+#endif
+void handle_int_receive_ch() {
+    handle_int_receive_channel(CH);
+}
+
+    // The interrupt handler of each channel
+static const rf_handler_t channel_handlers[RF433RECV_MAX_MANAGERS] = {
+    &handle_int_receive,
+#if RF433RECV_MAX_MANAGERS > 1
+    &handle_int_receive_ch<1>,
+#endif
+#if RF433RECV_MAX_MANAGERS > 2
+    &handle_int_receive_ch<2>,
+#endif
+#if RF433RECV_MAX_MANAGERS > 3
+    &handle_int_receive_ch<3>,
+#endif
+#if RF433RECV_MAX_MANAGERS > 4
+    &handle_int_receive_ch<4>,
+#endif
+#if RF433RECV_MAX_MANAGERS > 5
+    &handle_int_receive_ch<5>,
+#endif
+#if RF433RECV_MAX_MANAGERS > 6
+    &handle_int_receive_ch<6>,
+#endif
+#if RF433RECV_MAX_MANAGERS > 7
+    &handle_int_receive_ch<7>,
+#endif
+};
 
-    handle_int_busy = was_handle_int_busy;
+static rf_handler_t channel_handler(byte ch) {
+    return channel_handlers[ch];
 }
 
 // vim: ts=4:sw=4:tw=80:et
@@ -47,13 +47,39 @@
 
 #endif // RF433RECV_TESTPLAN
 
-    // The possibility *not* to compact durations is available for debugging
-    // purposes. You should not use it in normal circumstances.
+    // How signal durations are represented (type duration_t), see compact()
+    // in RF433recv.cpp:
+    //   DURATION_COMPACT8  8-bit (the default). Steps of 16 us below 2048 us,
+    //                      128 us below 17408 us and 4096 us above.
+    //   DURATION_LOG8      8-bit, in a logarithmic scale (each step is 1/32
+    //                      to 1/64 of the duration). Steps of 8 us below
+    //                      512 us, 16 us below 1024 us, ..., 512 us below
+    //                      32768 us. Better for protocols with short
+    //                      durations (a few hundreds of us).
+    //   DURATION_RAW16     16-bit, the durations are not compacted. Takes more
+    //                      RAM (automats, buffer of signals), and is not
+    //                      compatible with SHARED_EDGE_CLASSIFICATION.
+#define DURATION_COMPACT8 1
+#define DURATION_LOG8     2
+#define DURATION_RAW16    3
+
+    // Same as DURATION_ENCODING set to DURATION_RAW16, kept for compatibility.
 //#define NO_COMPACT_DURATIONS
 
+#ifndef DURATION_ENCODING
 #ifdef NO_COMPACT_DURATIONS
-#pragma message ("NO_COMPACT_DURATIONS MACRO DEFINED!")
-#warning "NO_COMPACT_DURATIONS MACRO DEFINED!"
+#define DURATION_ENCODING DURATION_RAW16
+#else
+#define DURATION_ENCODING DURATION_COMPACT8
+#endif
+#endif
+#if DURATION_ENCODING != DURATION_COMPACT8 \
+    && DURATION_ENCODING != DURATION_LOG8 \
+    && DURATION_ENCODING != DURATION_RAW16
+#error "DURATION_ENCODING must be DURATION_COMPACT8, DURATION_LOG8 or DURATION_RAW16"
+#endif
+#if defined(NO_COMPACT_DURATIONS) && DURATION_ENCODING != DURATION_RAW16
+#error "NO_COMPACT_DURATIONS requires DURATION_ENCODING to be DURATION_RAW16"
 #endif
 
 //#define DEBUG_AUTOMAT
@@ -63,22 +89,185 @@
 
 //#define DEBUG_EXEC_TIMES
 
-    // *IMPORTANT*
+    // Record, for each receiver, the time between the end of a code and the
+    // execution of the callbacks, and the duration of the callbacks, in
+    // histograms. See output_latencies_stats().
+//#define DEBUG_LATENCIES
+
+    // Execute automats with code generated at compile time (one function per
+    // automat line) instead of interpreting the automat tables. Faster, to the
+    // cost of a bigger code size. See "Specialized automats" in RF433recv.cpp.
+//#define SPECIALIZED_AUTOMATS
+#if defined(SPECIALIZED_AUTOMATS) && defined(DEBUG_AUTOMAT)
+#error "DEBUG_AUTOMAT has no effect with SPECIALIZED_AUTOMATS"
+#endif
+
+    // Classify each signal duration with one lookup in a table of each
+    // receiver (filled when registering it) instead of having every receiver
+    // compare it with its own boundaries. The cost of a signal then depends
+    // much less on the number of receivers, to the cost of 512 bytes of RAM
+    // per receiver (taken from the arena if one is set, see
+    // RF_manager::set_arena()). See "Shared edge classification" in
+    // RF433recv.cpp.
+//#define SHARED_EDGE_CLASSIFICATION
+#if defined(SHARED_EDGE_CLASSIFICATION) && DURATION_ENCODING == DURATION_RAW16
+#error "SHARED_EDGE_CLASSIFICATION requires 8-bit durations"
+#endif
+
+    // Have each receiver measure the durations of the codes it decodes
+    // (running averages of short, long, prefix, ... durations), so that
+    // RF_manager::recalibrate() can centre its boundaries on the timings of
+    // the actual transmitter. Costs a few instructions per signal, and about
+    // 100 bytes of RAM per receiver. See "Calibration" in RF433recv.cpp.
+//#define RF433RECV_CALIBRATION
+
+    // Protocol discovery: RF_manager records signals and works out the
+    // arguments of register_Receiver() from them, see
+    // RF_manager::start_discovery() and "Discovery" in RF433recv.cpp.
+    // RF433RECV_DISCOVERY_NB is the default number of signals recorded (2
+    // bytes each with 8-bit durations, allocated only while discovery runs).
+    // One RF_manager at a time can discover.
+//#define RF433RECV_DISCOVERY
+#ifndef RF433RECV_DISCOVERY_NB
+#ifdef __AVR__
+#define RF433RECV_DISCOVERY_NB 256
+#else
+#define RF433RECV_DISCOVERY_NB 1024
+#endif
+#endif
+
+    // Queue of the codes decoded, waiting for do_events() to execute their
+    // callbacks. Without it, a receiver that got a code decodes nothing until
+    // do_events() executes the callbacks, and the codes received in the
+    // meantime are lost. With it, the receiver puts the code in the queue and
+    // goes on decoding (see "Frame queue" in RF433recv.cpp).
+    //   RF433RECV_FRAME_QUEUE_NB is the number of entries of the queue. MUST
+    //   BE A POWER OF 2, the real capacity being one less (same as
+    //   BUFFER_SIGNALS_NB).
+    //   RF433RECV_FRAME_MAX_BITS is the maximum number of bits of a code that
+    //   goes through the queue (the receivers of longer codes work as if there
+    //   was no queue).
+//#define RF433RECV_FRAME_QUEUE_NB 8
+#ifdef RF433RECV_FRAME_QUEUE_NB
+#ifndef RF433RECV_FRAME_MAX_BITS
+#define RF433RECV_FRAME_MAX_BITS 64
+#endif
+#if RF433RECV_FRAME_QUEUE_NB < 2 \
+    || (RF433RECV_FRAME_QUEUE_NB & (RF433RECV_FRAME_QUEUE_NB - 1)) \
+    || RF433RECV_FRAME_QUEUE_NB > 256
+#error "RF433RECV_FRAME_QUEUE_NB must be a power of 2, in [2, 256]"
+#endif
+#if RF433RECV_FRAME_MAX_BITS < 1 || RF433RECV_FRAME_MAX_BITS > 255
+#error "RF433RECV_FRAME_MAX_BITS must be in [1, 255]"
+#endif
+#endif
+
+    // Number of receivers (per RF_manager) that RF_manager keeps track of with
+    // a set of bits, so that, among them, the ones waiting for an
+    // initialization sequence don't cost anything. The receivers registered
+    // past this number work all the same, but get processed on every signal.
+#ifndef RF433RECV_MAX_RECEIVERS
+#ifdef __AVR__
+#define RF433RECV_MAX_RECEIVERS 16
+#else
+#define RF433RECV_MAX_RECEIVERS 64
+#endif
+#endif
+#if RF433RECV_MAX_RECEIVERS < 1 || RF433RECV_MAX_RECEIVERS > 255
+#error "RF433RECV_MAX_RECEIVERS must be in [1, 255]"
+#endif
+
+    // Maximum number of RF_manager objects at the same time, each one with its
+    // own input pin, buffer of signals and receivers (RF433RECV_MAX_RECEIVERS
+    // is per RF_manager). See "Channels" in RF433recv.cpp.
+#ifndef RF433RECV_MAX_MANAGERS
+#ifdef __AVR__
+#define RF433RECV_MAX_MANAGERS 1
+#else
+#define RF433RECV_MAX_MANAGERS 4
+#endif
+#endif
+#if RF433RECV_MAX_MANAGERS < 1 || RF433RECV_MAX_MANAGERS > 8
+#error "RF433RECV_MAX_MANAGERS must be in [1, 8]"
+#endif
+
+    // Keep statistics of the occupancy of the band (edges per second, share
+    // of the durations that look like RF data, share of the time the band is
+    // busy), by windows of RF433RECV_STATS_WINDOW_MS milliseconds, the last
+    // RF433RECV_STATS_NB_WINDOWS of them being kept (16 bytes each, per
+    // RF_manager). Costs a few instructions per signal. See
+    // RF_manager::get_channel_stats().
+//#define RF433RECV_CHANNEL_STATS
+#ifdef RF433RECV_CHANNEL_STATS
+#ifndef RF433RECV_STATS_WINDOW_MS
+#define RF433RECV_STATS_WINDOW_MS 1000
+#endif
+#ifndef RF433RECV_STATS_NB_WINDOWS
+#define RF433RECV_STATS_NB_WINDOWS 8
+#endif
+#if RF433RECV_STATS_WINDOW_MS < 1
+#error "RF433RECV_STATS_WINDOW_MS must be at least 1"
+#endif
+#if RF433RECV_STATS_NB_WINDOWS < 1 || RF433RECV_STATS_NB_WINDOWS > 255
+#error "RF433RECV_STATS_NB_WINDOWS must be in [1, 255]"
+#endif
+#endif
+
+    // Provide InputCaptureEdgeSource, that timestamps edges with the input
+    // capture unit of Timer1 (pin ICP1, that is, pin 8 on an Arduino Uno).
+    // Timer1 and its interrupts then belong to RF433recv (no Servo library,
+    // no analogWrite() on pins 9 and 10). See "Edge sources" in
+    // RF433recv.cpp.
+//#define RF433RECV_INPUT_CAPTURE
+#if defined(RF433RECV_INPUT_CAPTURE) && !defined(__AVR__)
+#error "RF433RECV_INPUT_CAPTURE requires an AVR board"
+#endif
+
+    // Number of hash buckets of the callbacks of each receiver that are
+    // registered with a code (see Receiver::execute_callbacks()). When a code
+    // is received, only the callbacks of its bucket get compared with it.
+    //   MUST BE A POWER OF 2
+#ifndef RF433RECV_CALLBACK_BUCKETS
+#ifdef __AVR__
+#define RF433RECV_CALLBACK_BUCKETS 4
+#else
+#define RF433RECV_CALLBACK_BUCKETS 16
+#endif
+#endif
+#if RF433RECV_CALLBACK_BUCKETS < 1 \
+    || (RF433RECV_CALLBACK_BUCKETS & (RF433RECV_CALLBACK_BUCKETS - 1)) \
+    || RF433RECV_CALLBACK_BUCKETS > 256
+#error "RF433RECV_CALLBACK_BUCKETS must be a power of 2, in [1, 256]"
+#endif
+
+    // Size of the buffer of signals, between the interrupt handler that
+    // records them and the code that decodes them (see SignalRing below).
     //   MUST BE A POWER OF 2
     //     Because we need to calculate "modulo BUFFER_SIGNALS_NB", and as we
     //     don't want a long calculation to take place (yes we are in a
     //     microcontroller, plus, we are INSIDE an interrupt call...), we simply
-    //     use "& BUFFER_SIGNALS_MASK" instruction.
-    //   ALSO MAX VALUE IS 128 (BECAUSE THE VARIABLES TO WALK THROUGH THE BUFFER
-    //   ARE OF TYPE byte)
+    //     use "& (BUFFER_SIGNALS_NB - 1)" instruction.
+    //   MAX VALUE IS 256 ON AVR (the positions in the buffer must be of type
+    //   byte, to be read and written atomically), 1024 OTHERWISE.
     //   Note that we use a read_head and write_head, and both being equal
     //   means, there is no value to read. As a result, the real buffer size is
     //   not BUFFER_SIGNALS_NB but (BUFFER_SIGNALS_NB - 1).
     //   So with a 'raw' buffer size of 4, we have a real buffer of 3 durations
-    //   waiting for us to process. This is sufficient for our need.
-#define BUFFER_SIGNALS_NB 4 // DON'T CHANGE IT UNLESS YOU KNOW WHAT YOU ARE
-                            // DOING!!!
-#define BUFFER_SIGNALS_MASK (BUFFER_SIGNALS_NB - 1)
+    //   waiting for us to process. This is sufficient when signals are decoded
+    //   inside the interrupt handler. See RF_manager::get_dropped_signals() to
+    //   know whether it is sufficient or not.
+#ifndef BUFFER_SIGNALS_NB
+#define BUFFER_SIGNALS_NB 4
+#endif
+#if BUFFER_SIGNALS_NB < 2 || (BUFFER_SIGNALS_NB & (BUFFER_SIGNALS_NB - 1))
+#error "BUFFER_SIGNALS_NB must be a power of 2 (and at least 2)"
+#endif
+#if defined(__AVR__) && BUFFER_SIGNALS_NB > 256
+#error "BUFFER_SIGNALS_NB can't be above 256 on AVR"
+#endif
+#if BUFFER_SIGNALS_NB > 1024
+#error "BUFFER_SIGNALS_NB can't be above 1024"
+#endif
 
 #ifdef DEBUG
 
@@ -125,6 +314,35 @@ void output_measureexectimes_stats();
 #endif
 
 
+// * **************** *********************************************************
+// * LatencyHistogram *********************************************************
+// * **************** *********************************************************
+
+#ifdef DEBUG_LATENCIES
+
+    // Bucket b is for durations in [2^(b - 1), 2^b) microseconds, the last
+    // one is for durations above 2^(LATENCY_NB_BUCKETS - 2) (0.26 second)
+#define LATENCY_NB_BUCKETS 20
+
+class LatencyHistogram {
+    private:
+        uint16_t count[LATENCY_NB_BUCKETS];
+        unsigned long dmax;
+
+    public:
+        LatencyHistogram();
+
+        void add(unsigned long d);
+        void output_stats(const char *name, byte n) const;
+
+        void reset();
+};
+
+void output_latencies_stats();
+
+#endif
+
+
 // * ********* ****************************************************************
 // * BitVector ****************************************************************
 // * ********* ****************************************************************
@@ -135,8 +353,15 @@ class BitVector {
         byte target_nb_bits;
         byte target_nb_bytes;
         byte nb_bits;
+        bool own_array;
+        mutable bool hash_is_valid;
+        mutable uint16_t hash;
+    protected:
+        void load_bytes(short arg_nb_bits, short arg_nb_bytes,
+                const byte *bytes, short n);
     public:
         BitVector(byte arg_target_nb_bits);
+        BitVector(byte arg_target_nb_bits, uint8_t *storage);
         ~BitVector();
 
         BitVector(short arg_nb_bits, short arg_nb_bytes, byte b0, byte b1);
@@ -164,6 +389,73 @@ class BitVector {
         char *to_str() const;
 
         short cmp(const BitVector *p) const;
+        uint16_t get_hash() const;
+
+        void copy_bits_to(uint8_t *dst) const;
+        void load_bits(byte arg_nb_bits, const uint8_t *src);
+        void load_from(const BitVector *src);
+};
+
+    // A BitVector that holds its bits in itself, instead of in a malloc'd
+    // array.
+    // Example:
+    //   static InlineBitVector<32> code(32, 4, 0x8A, 0x34, 0xE6, 0xBF);
+    //   rf.register_callback(callback, 2000, &code);
+template <byte NBITS> class InlineBitVector: public BitVector {
+    static_assert(NBITS > 0, "InlineBitVector: NBITS must be > 0");
+    private:
+        uint8_t storage[(NBITS + 7) >> 3];
+    public:
+        InlineBitVector(): BitVector(NBITS, storage) { }
+        template <typename... Bytes>
+        InlineBitVector(short arg_nb_bits, short arg_nb_bytes, Bytes... bytes):
+                BitVector(NBITS, storage) {
+            const byte b[] = {(byte)bytes...};
+            load_bytes(arg_nb_bits, arg_nb_bytes, b, sizeof...(Bytes));
+        }
+        InlineBitVector(const InlineBitVector&) = delete;
+        InlineBitVector& operator=(const InlineBitVector&) = delete;
+};
+
+
+// * ********** ***************************************************************
+// * RF433Arena ***************************************************************
+// * ********** ***************************************************************
+
+    // A bump allocator: objects are taken one after the other from a buffer
+    // of fixed size, and are never given back individually.
+    // See RF_manager::set_arena().
+class RF433Arena {
+    private:
+        uint8_t *buf;
+        size_t size;
+        size_t used;
+    public:
+        RF433Arena(void *arg_buf, size_t arg_size):
+                buf((uint8_t*)arg_buf), size(arg_size), used(0) { }
+
+            // Returns nullptr if there is not enough room left
+        void *alloc(size_t n);
+        void release_to(size_t mark) { if (mark < used) used = mark; }
+        void reset() { used = 0; }
+
+        size_t get_size() const { return size; }
+        size_t get_used() const { return used; }
+};
+
+    // An arena that holds its buffer in itself, to be declared as a global or
+    // static variable, so that its size is accounted for at link time.
+    // Example:
+    //   static RF433StaticArena<400> arena;
+    //   ...
+    //   RF_manager::set_arena(&arena);
+template <size_t N> class RF433StaticArena: public RF433Arena {
+    private:
+        uint8_t storage[N];
+    public:
+        RF433StaticArena(): RF433Arena(storage, N) { }
+        RF433StaticArena(const RF433StaticArena&) = delete;
+        RF433StaticArena& operator=(const RF433StaticArena&) = delete;
 };
 
 
@@ -181,14 +473,57 @@ class BitVector {
 //   It'll say duration_t is unknown.
 //   So I end up using #define, that looks weird.
 //   avr-g++ works well with typedef.
-#ifdef NO_COMPACT_DURATIONS
+#if DURATION_ENCODING == DURATION_RAW16
 #define duration_t uint16_t
 #else
 #define duration_t byte
 #endif
 
-duration_t compact(uint16_t u);
-uint16_t uncompact(duration_t b);
+    // See "compact, uncompact" in RF433recv.cpp.
+    // Defined here as constexpr, for make_automat() below.
+
+#if DURATION_ENCODING == DURATION_LOG8
+    // v is the duration in units of 8 us, e is the exponent, starting at 1.
+constexpr duration_t compact_log8(uint16_t v, byte e = 1) {
+    return e > 7 ? 255
+        : v < (64u << (e - 1)) ? ((e - 1) << 5) + (v >> (e - 1))
+        : compact_log8(v, e + 1);
+}
+#endif
+
+constexpr duration_t compact(uint16_t u) {
+#if DURATION_ENCODING == DURATION_RAW16
+        // Durations not compacted -> compact() is a no-op
+    return u;
+#elif DURATION_ENCODING == DURATION_LOG8
+    return compact_log8(u >> 3);
+#else
+    return u < 2048 ? u >> 4
+        : u < 17408 ? 128 + ((u - 2048) >> 7)
+        : u < 46080 ? 248 + ((u - 17408) >> 12)
+        : 255;
+#endif
+}
+
+    // Returns the lowest duration u so that compact(u) == b.
+constexpr uint16_t uncompact(duration_t b) {
+#if DURATION_ENCODING == DURATION_RAW16
+    return b;
+#elif DURATION_ENCODING == DURATION_LOG8
+    return b < 64 ? b << 3 : (((b & 31) + 32) << ((b >> 5) - 1)) << 3;
+#else
+    return b < 128 ? b << 4
+        : (b & 0x7f) < 120 ? ((b & 0x7f) << 7) + 2048
+        : (((b & 0x7f) - 120) << 12) + 17408;
+#endif
+}
+
+    // A signal, as recorded by the interrupt handler: its duration, and the
+    // level of the signal that follows it.
+struct sbuf_entry_t {
+    byte signal_val;
+    duration_t compact_signal_duration;
+};
 
 #define RFMOD_TRIBIT          0
 #define RFMOD_TRIBIT_INVERTED 1
@@ -245,6 +580,30 @@ enum ad_field_idx {
 };
 #define AD_INDIRECT 0x80
 
+    // A class of durations is a (min, max) pair of boundaries, as found in
+    // W_CHECK_DURATION lines of the automats (see edge_class_bounds in
+    // RF433recv.cpp).
+enum edge_class_idx {
+    EC_INITSEQ,
+    EC_LO_PREFIX,
+    EC_HI_PREFIX,
+    EC_FIRST_LO_IGN,
+    EC_LO_SHORT,
+    EC_LO_LONG,
+    EC_HI_SHORT,
+    EC_HI_LONG,
+    EC_LO_LAST,
+    EC_SEP,
+    EC_LO_ANY,
+    EC_HI_ANY,
+    EC_NB,
+    EC_NONE = 255
+};
+    // The classes measured by RF433RECV_CALIBRATION, from EC_LO_PREFIX to
+    // EC_LO_LAST (the ones that have an upper boundary and match one duration
+    // of register_Receiver()).
+#define CAL_NB_CLASSES (EC_LO_LAST - EC_LO_PREFIX + 1)
+
 struct autoline_t {
     byte w;
     byte ad_field_idx_minval;
@@ -253,17 +612,259 @@ struct autoline_t {
     byte next_if_w_false;
 };
 
+    // The automat table to execute is found from mod (see automat_descs in
+    // RF433recv.cpp), so that an autoexec_t can be built at compile time, see
+    // make_automat() below.
 struct autoexec_t {
-    const autoline_t *mat;
-    unsigned short mat_len;
+    byte mod;
     duration_t values[AD_NB_FIELDS];
 };
 
+// * ************ *************************************************************
+// * make_automat *************************************************************
+// * ************ *************************************************************
+
+// make_automat() calculates an autoexec_t the way build_automat() does (the
+// latter actually calls the former), but it can be evaluated at compile
+// time. The values then don't need to be calculated, nor allocated, at run
+// time, and invalid arguments are detected by the compiler.
+// Example:
+//   static constexpr autoexec_t otio = make_automat(RFMOD_TRIBIT, 4956, 0, 0,
+//           0, 580, 1274, 0, 0, 520, 4956, 32);
+//   ...
+//   rf.register_Receiver(&otio, callback, 2000);
+//
+// Arguments are the same as register_Receiver() ones, plus the decode mood
+// (see DecodeMood below).
+// As the code is C++11, each function is made of one return statement.
+
+    // How wide the ranges of durations are, see automat_boundary() below.
+    //   LAXIST   The default
+    //   STRICT   Durations must be within +/- 25% of their nominal value
+    //   CUSTOM   Durations must be within +/- tolerance % of their nominal
+    //            value (tolerance in [1, 100])
+enum class DecodeMood: byte {LAXIST, STRICT, CUSTOM};
+
+struct automat_args_t {
+    byte mod;
+    uint16_t initseq;
+    uint16_t lo_prefix;
+    uint16_t hi_prefix;
+    uint16_t first_lo_ign;
+    uint16_t lo_short;
+    uint16_t lo_long;
+    uint16_t hi_short;
+    uint16_t hi_long;
+    uint16_t lo_last;
+    uint16_t sep;
+    byte nb_bits;
+    DecodeMood mood;
+    byte tolerance;
+};
+
+    // Not constexpr, on purpose: when make_automat() is evaluated at compile
+    // time with invalid arguments, the compiler stops with an error about
+    // the call of this function.
+void automat_invalid_arguments();
+
+constexpr bool automat_args_are_valid(const automat_args_t& a) {
+    return a.nb_bits && a.lo_short
+        && (a.mood != DecodeMood::CUSTOM || (a.tolerance && a.tolerance <= 100))
+        && (a.mod == RFMOD_MANCHESTER ? !a.lo_prefix && !a.hi_prefix
+            : (a.mod == RFMOD_TRIBIT || a.mod == RFMOD_TRIBIT_INVERTED)
+                && (!a.lo_prefix == !a.hi_prefix)
+                && (!a.hi_short == !a.hi_long));
+}
+
+    // Short and long durations, once defaults are applied.
+constexpr uint16_t automat_lo_long(const automat_args_t& a) {
+    return a.mod == RFMOD_MANCHESTER ? a.lo_short << 1 : a.lo_long;
+}
+constexpr uint16_t automat_hi_short(const automat_args_t& a) {
+    return a.hi_short ? a.hi_short : a.lo_short;
+}
+constexpr uint16_t automat_hi_long(const automat_args_t& a) {
+    return a.mod == RFMOD_MANCHESTER ? automat_hi_short(a) << 1
+        : a.hi_short ? a.hi_long : a.lo_long;
+}
+
+constexpr byte automat_tolerance(const automat_args_t& a) {
+    return a.mood == DecodeMood::STRICT ? 25 : a.tolerance;
+}
+
+constexpr uint16_t automat_min16(uint32_t v) {
+    return v > 65535 ? 65535 : v;
+}
+
+    // d +/- pct %, compacted
+constexpr duration_t automat_window(uint16_t d, byte pct, bool is_sup) {
+    return compact(is_sup ? automat_min16(d + (uint32_t)d * pct / 100)
+                          : d - (uint16_t)((uint32_t)d * pct / 100));
+}
+
+    // Range of a duration that is neither short nor long (prefix, last low,
+    // first low to ignore). lax_shift gives the range of the LAXIST mood:
+    // 2 => [d * 0.75, d * 1.25], 1 => [d / 2, d * 1.5].
+constexpr duration_t automat_range(const automat_args_t& a, uint16_t d,
+        byte lax_shift, bool is_sup) {
+    return a.mood != DecodeMood::LAXIST ?
+            automat_window(d, automat_tolerance(a), is_sup)
+        : is_sup ? compact(d + (d >> lax_shift))
+        : lax_shift == 1 ? compact(d >> 1)
+        : compact(d - (d >> 2));
+}
+
+constexpr duration_t automat_max(duration_t a, duration_t b) {
+    return a >= b ? a : b;
+}
+constexpr duration_t automat_min(duration_t a, duration_t b) {
+    return a <= b ? a : b;
+}
+
+    // Boundary of a pair of short and long durations, with which:
+    //   0: short inf, 1: short sup, 2: long inf, 3: long sup.
+    // Normally the short is... shorter than the long, yes! But, some specs (in
+    // RCSwitch) work the other way round, and we have to handle it gracefully.
+    // When short and long are equal, it is meant to handle cases like
+    // "RCSwitch protocol 8" where the hi signal has no 'short' and 'long'
+    // durations, only the lo one differs.
+    //
+    // With LAXIST mood, the boundaries are calculated so that a given signal
+    // length will be identified as "short versus long" as follows:
+    //   short <=> duration in [short / 4, avg(short, long)]
+    //   long  <=> duration in [avg(short, long) + 1, long * 1.5]
+    // (The use of compact numbers will also modify these boundaries a bit, but
+    // this is another story.)
+    //
+    // This is a bit laxist. With STRICT mood, ranges are:
+    //   short <=> duration in [short * 0.75, short * 1.25]
+    //   long  <=> duration in [long * 0.75, long * 1.25]
+    // and with CUSTOM mood, the same with the tolerance instead of 25%.
+    // Whatever the tolerance, short and long ranges don't overlap: they don't
+    // go past avg(short, long).
+    //
+    // Stricter ranges reject non-matching signals earlier, that is welcome
+    // when many receivers are registered, but they reject more codes sent by
+    // a device whose timings drift.
+constexpr duration_t automat_boundary_ordered(const automat_args_t& a,
+        uint16_t sig_short, uint16_t sig_long, byte which) {
+    return a.mood == DecodeMood::LAXIST ?
+          (which == 0 ? compact(sig_short >> 2)
+         : which == 1 ? compact((sig_short + sig_long) >> 1)
+         : which == 2 ?
+            (duration_t)(compact((sig_short + sig_long) >> 1) + 1)
+         : compact(sig_long + (sig_long >> 1)))
+        : (which == 0 ? automat_window(sig_short, automat_tolerance(a), false)
+         : which == 1 ?
+            automat_min(automat_window(sig_short, automat_tolerance(a), true),
+                    compact((sig_short + sig_long) >> 1))
+         : which == 2 ?
+            automat_max(automat_window(sig_long, automat_tolerance(a), false),
+                    (duration_t)(compact((sig_short + sig_long) >> 1) + 1))
+         : automat_window(sig_long, automat_tolerance(a), true));
+}
+constexpr duration_t automat_boundary(const automat_args_t& a,
+        uint16_t sig_short, uint16_t sig_long, byte which) {
+    return sig_short == sig_long ? automat_range(a, sig_short, 1, which & 1)
+        : sig_short > sig_long ?
+            automat_boundary_ordered(a, sig_long, sig_short, which ^ 2)
+        : automat_boundary_ordered(a, sig_short, sig_long, which);
+}
+
+constexpr duration_t automat_lo_boundary(const automat_args_t& a,
+        byte which) {
+    return automat_boundary(a, a.lo_short, automat_lo_long(a), which);
+}
+constexpr duration_t automat_hi_boundary(const automat_args_t& a,
+        byte which) {
+    return automat_boundary(a, automat_hi_short(a), automat_hi_long(a), which);
+}
+
+constexpr duration_t automat_sep_inf(const automat_args_t& a) {
+    return compact(a.sep - (a.sep >> 2))
+            > automat_max(automat_lo_boundary(a, 3), automat_hi_boundary(a, 3))
+        ? compact(a.sep - (a.sep >> 2))
+        : (duration_t)(automat_max(automat_lo_boundary(a, 3),
+                    automat_hi_boundary(a, 3)) + 1);
+}
+
+    // AD_NEXT_PREFIX and AD_NEXT_SPECIAL are line numbers in the automat
+    // tables of RF433recv.cpp.
+constexpr duration_t automat_value(const automat_args_t& a, byte idx) {
+    return
+      idx == AD_INITSEQ_INF ? compact(a.initseq - (a.initseq >> 2))
+    : idx == AD_LO_PREFIX_INF ?
+        (a.lo_prefix ? automat_range(a, a.lo_prefix, 2, false) : compact(32000))
+    : idx == AD_LO_PREFIX_SUP ?
+        (a.lo_prefix ? automat_range(a, a.lo_prefix, 2, true) : compact(32000))
+    : idx == AD_HI_PREFIX_INF ?
+        (a.lo_prefix ? automat_range(a, a.hi_prefix, 2, false) : compact(32000))
+    : idx == AD_HI_PREFIX_SUP ?
+        (a.lo_prefix ? automat_range(a, a.hi_prefix, 2, true) : compact(32000))
+    : idx == AD_FIRST_LO_IGN_INF ? automat_range(a, a.first_lo_ign, 1, false)
+    : idx == AD_FIRST_LO_IGN_SUP ? automat_range(a, a.first_lo_ign, 1, true)
+    : idx >= AD_LO_SHORT_INF && idx <= AD_LO_LONG_SUP ?
+        automat_lo_boundary(a, idx - AD_LO_SHORT_INF)
+    : idx >= AD_HI_SHORT_INF && idx <= AD_HI_LONG_SUP ?
+        automat_hi_boundary(a, idx - AD_HI_SHORT_INF)
+    : idx == AD_LO_LAST_INF ?
+        (a.lo_last ? automat_range(a, a.lo_last, 1, false)
+         : automat_lo_boundary(a, 0))
+    : idx == AD_LO_LAST_SUP ?
+        (a.lo_last ? automat_range(a, a.lo_last, 1, true)
+         : automat_lo_boundary(a, 3))
+    : idx == AD_SEP_INF ? automat_sep_inf(a)
+    : idx == AD_NB_BITS ? a.nb_bits
+    : idx == AD_NEXT_PREFIX ?
+        (a.mod == RFMOD_MANCHESTER ? 255 : a.lo_prefix ? 18 : 3)
+    : idx == AD_NEXT_SPECIAL ?
+        (a.mod != RFMOD_TRIBIT_INVERTED ? 255
+         : automat_hi_short(a) == automat_hi_long(a) ? 22 : 0)
+    : idx == AD_BIT_0 ? 0
+    : idx == AD_BIT_1 ? 1
+    : 0;
+}
+
+template<byte... I> struct automat_seq { };
+template<byte N, byte... I> struct automat_make_seq:
+    automat_make_seq<N - 1, N - 1, I...> { };
+template<byte... I> struct automat_make_seq<0, I...> {
+    typedef automat_seq<I...> type;
+};
+
+template<byte... I>
+constexpr autoexec_t make_automat_values(const automat_args_t& a,
+        automat_seq<I...>) {
+    return autoexec_t{ a.mod, { automat_value(a, I)... } };
+}
+
+constexpr autoexec_t make_automat(const automat_args_t& a) {
+    return automat_args_are_valid(a) ?
+        make_automat_values(a, automat_make_seq<AD_NB_FIELDS>::type())
+        : (automat_invalid_arguments(),
+           make_automat_values(a, automat_make_seq<AD_NB_FIELDS>::type()));
+}
+
+constexpr autoexec_t make_automat(byte mod, uint16_t initseq,
+        uint16_t lo_prefix, uint16_t hi_prefix, uint16_t first_lo_ign,
+        uint16_t lo_short, uint16_t lo_long, uint16_t hi_short,
+        uint16_t hi_long, uint16_t lo_last, uint16_t sep, byte nb_bits,
+        DecodeMood mood = DecodeMood::LAXIST, byte tolerance = 0) {
+    return make_automat(automat_args_t{ mod, initseq, lo_prefix, hi_prefix,
+            first_lo_ign, lo_short, lo_long, hi_short, hi_long, lo_last, sep,
+            nb_bits, mood, tolerance });
+}
+
+autoexec_t* build_automat(const automat_args_t& args,
+        autoexec_t *pax = nullptr);
+
 struct callback_t {
     const BitVector *pcode;
     void (*func)(const BitVector *recorded);
     uint32_t min_delay_between_two_calls;
     uint32_t last_trigger;
+        // Registration order, to execute callbacks in this order
+    uint16_t seq;
 
     callback_t *next;
 };
@@ -271,36 +872,104 @@ struct callback_t {
 autoexec_t* build_automat(byte mod, uint16_t initseq, uint16_t lo_prefix,
         uint16_t hi_prefix, uint16_t first_lo_ign, uint16_t lo_short,
         uint16_t lo_long, uint16_t hi_short, uint16_t hi_long, uint16_t lo_last,
-        uint16_t sep, byte nb_bits);
+        uint16_t sep, byte nb_bits, autoexec_t *pax = nullptr);
+
+#ifdef SPECIALIZED_AUTOMATS
+class Receiver;
+template<byte MOD, byte NP, byte NS> class SpecAutomat;
+typedef byte (*spec_dispatch_t)(Receiver *self, byte status,
+        duration_t compact_signal_duration, byte signal_val);
+#endif
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+struct rf_frame_t;
+#endif
 
 class Receiver {
+#ifdef SPECIALIZED_AUTOMATS
+    template<byte MOD, byte NP, byte NS> friend class SpecAutomat;
+#endif
+
     private:
         const autoexec_t *pax;
         const byte n;
         byte status;
         BitVector *recorded;
         bool has_value;
+            // False when allocated in an arena (see RF433Arena)
+        bool owns_memory;
+        bool owns_pax;
 
+            // Callbacks registered without a code
         callback_t *callback_head;
+        callback_t *callback_tail;
+            // Callbacks registered with a code, by hash of the code
+        callback_t *callback_buckets[RF433RECV_CALLBACK_BUCKETS];
+        uint16_t callback_seq;
 
         Receiver *next;
 
+#ifdef SPECIALIZED_AUTOMATS
+        spec_dispatch_t spec_dispatch;
+#endif
+#ifdef SHARED_EDGE_CLASSIFICATION
+            // The classes of each compacted duration, see get_edge_classes()
+        uint16_t *edge_class_table;
+#endif
+#ifdef DEBUG_LATENCIES
+        unsigned long complete_t;
+        LatencyHistogram latency_wait;
+        LatencyHistogram latency_call;
+#endif
+#ifdef RF433RECV_CALIBRATION
+            // The arguments pax got built with, if known (pax is then owned by
+            // the receiver)
+        automat_args_t cal_args;
+        bool cal_has_args;
+            // Durations (in microseconds) of the code being received
+        uint32_t cal_code_sum[CAL_NB_CLASSES];
+        uint16_t cal_code_nb[CAL_NB_CLASSES];
+            // Running averages over the codes received
+        uint16_t cal_avg[CAL_NB_CLASSES];
+        byte cal_nb_codes[CAL_NB_CLASSES];
+            // The automat once recalibrated (pax then points to it)
+        autoexec_t cal_ax;
+
+        void calibration_start();
+        void calibration_add(byte ec, duration_t compact_signal_duration);
+        void calibration_commit();
+#endif
+#ifdef RF433RECV_FRAME_QUEUE_NB
+            // micros() when the code got complete
+        unsigned long value_t;
+            // Of the RF_manager, to find its frame queue
+        byte channel;
+#endif
+
         bool w_compare(duration_t minval, duration_t maxval, duration_t val)
             const;
 
-        callback_t* get_callback_tail() const;
-
         duration_t get_val(byte idx) const;
 
+        byte run(byte st, duration_t compact_signal_duration,
+                byte signal_val);
+
     public:
-        Receiver(autoexec_t *arg_pax, byte n);
+        Receiver(const autoexec_t *arg_pax, byte n,
+                BitVector *arg_recorded = nullptr, bool arg_owns_pax = true);
         ~Receiver();
 
         void process_signal(duration_t compact_signal_duration,
                 byte signal_val);
+        size_t process_signals(const sbuf_entry_t *edges, size_t n);
 
         void reset();
 
+        byte get_status() const { return status; }
+        duration_t get_initseq_inf() const {
+            return pax->values[AD_INITSEQ_INF];
+        }
+
         bool get_has_value() const { return has_value; }
         const BitVector *get_recorded() const { return recorded; }
 
@@ -309,48 +978,356 @@ class Receiver {
 
         void add_callback(callback_t *pcb);
         byte execute_callbacks();
+        byte execute_callbacks(const BitVector *code, unsigned long code_t);
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        void set_channel(byte arg_channel) { channel = arg_channel; }
+        bool queue_value();
+        unsigned long get_value_t() const { return value_t; }
+        void restore_value(const rf_frame_t *frame);
+#endif
+
+#ifdef DEBUG_LATENCIES
+        void output_latencies_stats(byte num) const;
+#endif
+
+#ifdef SHARED_EDGE_CLASSIFICATION
+        uint16_t get_edge_classes(duration_t d) const;
+        void set_edge_class_table(uint16_t *table);
+#endif
+
+#ifdef RF433RECV_CALIBRATION
+        void set_calibration_args(const automat_args_t& args);
+        uint16_t get_calibrated_duration(byte ec) const;
+        byte get_calibration_nb_codes(byte ec) const;
+        void reset_calibration();
+        bool recalibrate(byte min_codes);
+#endif
 };
 
 
 // * ********** ***************************************************************
-// * RF_manager ***************************************************************
+// * SignalRing ***************************************************************
 // * ********** ***************************************************************
 
-// IMPORTANT
-//   KEEP IN MIND RF_MANAGER CAN BE INSTANCIATED ONLY ONCE.
-// It is verified with obj_count static property (if it goes above 1, it causes
-// an assert to fail).
+// Buffer of N elements of type T, for one producer (the interrupt handler)
+// and one consumer, that don't need to disable interrupts to use it: the
+// producer only writes write_head, the consumer only writes read_head.
+//
+// When the buffer is full, the new element is dropped (the producer can't
+// touch read_head), and counted as such.
 //
-// This means, the distinction between static and non-static properties and
-// static and non static member functions is pointless.
-// It is done though, for the sake of... I don't know what!
+// Each side publishes its index with a release store, after it is done with
+// the element, and reads the index of the other side with an acquire load,
+// before it touches the element: neither the compiler nor the CPU (with two
+// cores, like on ESP32) can then move the accesses to an element across the
+// update of the index that hands it over.
+
+template<bool SMALL> struct SignalRingIndex { typedef uint16_t type; };
+template<> struct SignalRingIndex<true> { typedef byte type; };
+
+template<class T, unsigned int N>
+class SignalRing {
+    static_assert(N >= 2 && !(N & (N - 1)), "N must be a power of 2");
+
+    typedef typename SignalRingIndex<(N <= 256)>::type index_t;
+
+    private:
+        T buf[N];
+        volatile index_t write_head;
+        volatile index_t read_head;
+
+            // Written by the producer only
+        volatile index_t high_water_mark;
+        volatile uint32_t dropped;
+
+            // index_t is a byte on AVR (see BUFFER_SIGNALS_NB), so that these
+            // need no lock there.
+        static index_t load_acquire(const volatile index_t *v) {
+            return __atomic_load_n(v, __ATOMIC_ACQUIRE);
+        }
+        static void store_release(volatile index_t *v, index_t x) {
+            __atomic_store_n(v, x, __ATOMIC_RELEASE);
+        }
+
+    public:
+        SignalRing():
+            write_head(0),
+            read_head(0),
+            high_water_mark(0),
+            dropped(0) { }
+
+            // Producer side
+        bool push(const T& e) {
+            const index_t w = write_head;
+            const index_t next_w = (w + 1) & (N - 1);
+            const index_t r = load_acquire(&read_head);
+            if (next_w == r) {
+                ++dropped;
+                return false;
+            }
+            buf[w] = e;
+            store_release(&write_head, next_w);
+
+            const index_t nb = (next_w - r) & (N - 1);
+            if (nb > high_water_mark)
+                high_water_mark = nb;
+            return true;
+        }
+
+            // Consumer side
+        bool pop(T *e) {
+            const index_t r = read_head;
+            if (r == load_acquire(&write_head))
+                return false;
+            *e = buf[r];
+            store_release(&read_head, (r + 1) & (N - 1));
+            return true;
+        }
+
+            // Consumer side, to read elements without copying them: sets *p
+            // to the first element to read, and returns how many can be read
+            // from there (up to the end of buf, not beyond).
+            // They remain in the buffer until consume() is called.
+        index_t peek(const T **p) const {
+            const index_t r = read_head;
+            const index_t w = load_acquire(&write_head);
+            *p = &buf[r];
+            return (w >= r ? w : N) - r;
+        }
+        void consume(index_t n) {
+            store_release(&read_head, (read_head + n) & (N - 1));
+        }
+
+        bool is_empty() const { return read_head == write_head; }
+
+            // As the counters below are written by the interrupt handler,
+            // reading them from outside it must be done with interrupts
+            // disabled (multi-byte values).
+        uint32_t get_dropped() const { return dropped; }
+        index_t get_high_water_mark() const { return high_water_mark; }
+        void reset_stats() {
+            dropped = 0;
+            high_water_mark = 0;
+        }
+
+            // Drops all elements, to be called while neither the producer nor
+            // the consumer runs.
+        void clear() {
+            read_head = write_head;
+            reset_stats();
+        }
+};
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+    // A code decoded by a receiver, waiting in the frame queue for do_events()
+    // to execute its callbacks (bits as stored by BitVector).
+struct rf_frame_t {
+    Receiver *rec;
+    unsigned long t;    // micros() when the code got complete
+    byte nb_bits;
+    uint8_t bits[(RF433RECV_FRAME_MAX_BITS + 7) >> 3];
+};
+#endif
+
+
+#ifdef RF433RECV_CHANNEL_STATS
+    // The occupancy of the band during a period of time, see
+    // RF_manager::get_channel_stats().
+struct channel_stats_t {
+    uint32_t duration_ms;   // Length of the period
+    uint32_t edges;
+    uint32_t plausible;     // Edges after a duration in [200, 25000] us
+    uint32_t busy_us;       // Time the band was busy (see wait_free_433())
+
+    uint32_t get_edges_per_second() const {
+        return duration_ms ? edges * 1000 / duration_ms : 0;
+    }
+    byte get_plausible_percent() const {
+        return edges ? plausible * 100 / edges : 0;
+    }
+    byte get_busy_percent() const {
+        if (!duration_ms)
+            return 0;
+        uint32_t p = busy_us / 10 / duration_ms;
+        return p > 100 ? 100 : p;
+    }
+};
+#endif
+
+
+// * ************ *************************************************************
+// * Edge sources *************************************************************
+// * ************ *************************************************************
+
+    // The interrupt handler of an RF_manager, see "Channels" in RF433recv.cpp
+typedef void (*rf_handler_t)();
+
+// Where the edges of the signal come from. The source has the interrupt
+// handler of the RF_manager called on each edge (attach()), and the handler
+// calls read_edge() to get the duration and the level of the signal.
+// GpioEdgeSource is the default, see RF_manager::set_edge_source().
+class EdgeSource {
+    public:
+        virtual ~EdgeSource() { }
+
+            // Have handler called on each edge, until detach() gets called.
+        virtual void attach(rf_handler_t handler) = 0;
+        virtual void detach() = 0;
+
+            // Called by the handler. Returns false if there is no edge to
+            // record. Otherwise, sets *duration to the duration of the signal
+            // that just ended (microseconds, at most 65535), and *level to the
+            // level of the signal that starts.
+        virtual bool read_edge(uint16_t *duration, byte *level) = 0;
+};
+
+    // How GpioEdgeSource knows the level of the signal after an edge.
+    //   READ     The pin is read on every edge (the default)
+    //   TOGGLE   The level is toggled on every edge (a CHANGE interrupt means
+    //            the level changed), and the pin is read only after a signal
+    //            of at least resync_duration, or every 64 edges, to catch up
+    //            with an edge that got missed (counted, see
+    //            GpioEdgeSource::get_level_desyncs()).
+enum class LevelMode: byte {READ, TOGGLE};
+
+    // Pin change interrupt (attachInterrupt()), edges timestamped with
+    // micros() (4 us resolution on a 16 MHz AVR).
+class GpioEdgeSource: public EdgeSource {
+    private:
+        byte pin;
+        byte int_num;
+        unsigned long last_t;
+#ifdef __AVR__
+            // The pin is read directly from its port (digitalRead() takes a
+            // few microseconds).
+        volatile uint8_t *in_reg;
+        uint8_t in_mask;
+#endif
+
+        LevelMode level_mode;
+        uint16_t resync_duration;
+        byte level;
+        byte edges_before_resync;
+        uint32_t level_desyncs;
+
+        byte read_pin() const;
+
+    public:
+        GpioEdgeSource(byte arg_pin, byte arg_int_num);
+
+        void attach(rf_handler_t handler) override;
+        void detach() override;
+        bool read_edge(uint16_t *duration, byte *level) override;
+
+        void set_level_mode(LevelMode mode, uint16_t resync_duration = 5000);
+        LevelMode get_level_mode() const { return level_mode; }
+        uint32_t get_level_desyncs() const;
+};
+
+#ifdef RF433RECV_INPUT_CAPTURE
+    // Input capture unit of Timer1: the hardware timestamps the edges (0.5 us
+    // resolution at 16 MHz), whatever the latency of the interrupt. The input
+    // pin is ICP1, whatever the pin given to RF_manager (that is still used
+    // by wait_free_433()).
+class InputCaptureEdgeSource: public EdgeSource {
+    private:
+        uint32_t last_ticks;
+        uint8_t saved_tccr1a;
+        uint8_t saved_tccr1b;
+        uint8_t saved_timsk1;
+
+    public:
+        InputCaptureEdgeSource(): last_ticks(0) { }
+
+        void attach(rf_handler_t handler) override;
+        void detach() override;
+        bool read_edge(uint16_t *duration, byte *level) override;
+};
+#endif
+
+
+// * ********** ***************************************************************
+// * RF_manager ***************************************************************
+// * ********** ***************************************************************
+
+// Up to RF433RECV_MAX_MANAGERS RF_manager objects can exist at the same time,
+// one per input pin (several receivers, or antennas), each one being a
+// channel: it has its own receivers, its own buffer of signals and its own
+// interrupt handler. The arena (see set_arena()) is shared by all of them.
 class RF_manager {
     private:
 
-        static byte obj_count; // Should never be > 1
-        static byte pin_input_num;
-        static Receiver *head;
+        static byte obj_count;
+        static RF433Arena *arena;
+        static uint32_t dedup_delay;
+
+        byte channel;
+        byte pin_input_num;
+        Receiver *head;
+
+        bool deferred_decoding;
 
         static volatile uint16_t IH_wait_free_last16;
         static volatile short IH_wait_free_count_ok;
 
         byte int_num;
 
+        GpioEdgeSource gpio_source;
+        EdgeSource *edge_source;
+
         bool opt_wait_free_433_is_set;
         uint32_t opt_wait_free_433_timeout;
+        bool opt_wait_free_433_async;
+        bool wait_free_433_is_pending;
+        uint32_t wait_free_433_t0;
+            // See ih_track_occupancy()
+        volatile uint16_t occupancy_last16;
+        volatile short occupancy_count_ok;
 
         bool handle_int_receive_interrupts_is_set;
 
         bool first_decoder_that_has_a_value_resets_others;
         bool inactivate_interrupts_handler_when_a_value_has_been_received;
 
+        DecodeMood decode_mood;
+        byte decode_tolerance;
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        static unsigned long code_timestamp;
+#endif
+
+        bool add_Receiver(const autoexec_t *static_pax,
+                const automat_args_t *args,
+                void (*func)(const BitVector *recorded),
+                uint32_t min_delay_between_two_calls);
+
+        bool decode_buffered_signals();
+        void execute_receivers_callbacks();
+        void before_callbacks(bool *deja_vu,
+                bool *reactivate_interrupts_handler_in_the_end,
+                bool *has_waited_free_433);
+        bool is_duplicate(const BitVector *code) const;
+        bool poll_free_433();
+#ifdef RF433RECV_CHANNEL_STATS
+        void update_channel_stats();
+#endif
+
     public:
 
-        static byte get_pin_input_num() { return pin_input_num; }
-        static Receiver* get_head() { return head; }
-        static Receiver* get_tail();
+        byte get_channel() const { return channel; }
+        byte get_pin_input_num() const { return pin_input_num; }
+        Receiver* get_head() const { return head; }
+        Receiver* get_tail() const;
+        bool get_deferred_decoding() const { return deferred_decoding; }
+        EdgeSource* get_edge_source() const { return edge_source; }
+        GpioEdgeSource* get_gpio_source() { return &gpio_source; }
+        void set_edge_source(EdgeSource *src);
+        static RF433Arena* get_arena() { return arena; }
+        static void set_arena(RF433Arena *arg_arena);
 
         static void ih_handle_interrupt_wait_free();
+        void ih_track_occupancy(uint16_t d);
 
         void activate_interrupts_handler();
         void inactivate_interrupts_handler();
@@ -359,26 +1336,72 @@ class RF_manager {
         RF_manager(byte arg_pin_input_num, byte arg_int_num);
         ~RF_manager();
 
-        void register_Receiver(byte mod, uint16_t initseq, uint16_t lo_prefix,
+        bool register_Receiver(byte mod, uint16_t initseq, uint16_t lo_prefix,
                 uint16_t hi_prefix, uint16_t first_lo_ign, uint16_t lo_short,
                 uint16_t lo_long, uint16_t hi_short, uint16_t hi_long,
                 uint16_t lo_last, uint16_t sep, byte nb_bits,
                 void (*func)(const BitVector *recorded) = nullptr,
                 uint32_t min_delay_between_two_calls = 0);
+        bool register_Receiver(const autoexec_t *pax,
+                void (*func)(const BitVector *recorded) = nullptr,
+                uint32_t min_delay_between_two_calls = 0);
+        bool register_Receiver(const automat_args_t& args,
+                void (*func)(const BitVector *recorded) = nullptr,
+                uint32_t min_delay_between_two_calls = 0);
 
         bool get_has_value() const;
         Receiver* get_receiver_that_has_a_value() const;
 
         void wait_value_available();
 
-        void register_callback(void (*func) (const BitVector *recorded),
+        bool register_callback(void (*func) (const BitVector *recorded),
                 uint32_t min_delay_between_two_calls,
                 const BitVector *pcode = nullptr);
 
         void do_events();
 
-        void set_opt_wait_free_433(bool v, uint32_t timeout = 0);
+        void replay(const uint16_t *durations, size_t n, byte first_level);
+        void process_signals(const sbuf_entry_t *edges, size_t n);
+
+        uint32_t get_dropped_signals() const;
+        uint16_t get_signals_high_water_mark() const;
+        void reset_signals_stats();
+
+        static void set_dedup_delay(uint32_t ms) { dedup_delay = ms; }
+
+#ifdef RF433RECV_FRAME_QUEUE_NB
+        uint32_t get_frame_queue_overflows() const;
+        uint16_t get_frames_high_water_mark() const;
+            // micros() when the code whose callbacks are being executed got
+            // complete
+        static unsigned long get_code_timestamp() { return code_timestamp; }
+#endif
+
+        void set_decode_mood(DecodeMood mood, byte tolerance = 0);
+        DecodeMood get_decode_mood() const { return decode_mood; }
+
+#ifdef RF433RECV_CALIBRATION
+        byte recalibrate(byte min_codes = 4);
+#endif
+
+#ifdef RF433RECV_DISCOVERY
+        bool start_discovery(uint16_t nb_signals = RF433RECV_DISCOVERY_NB);
+        static void stop_discovery();
+        static bool discover(automat_args_t *args);
+#endif
+
+        void set_opt_wait_free_433(bool v, uint32_t timeout = 0,
+                bool async = false);
         void wait_free_433();
+        bool get_band_is_busy() const;
+
+#ifdef RF433RECV_CHANNEL_STATS
+        byte get_channel_stats(channel_stats_t *st,
+                byte nb_windows = RF433RECV_STATS_NB_WINDOWS);
+        void reset_channel_stats();
+#endif
+
+        void set_deferred_decoding(bool val);
 
         void set_first_decoder_that_has_a_value_resets_others(bool val) {
             first_decoder_that_has_a_value_resets_others = val;
@@ -0,0 +1,144 @@
+// Arduino.h
+
+/*
+  Minimal stand-in for the Arduino core, so that RF433recv can be compiled and
+  executed natively on a host (tested on Linux with g++).
+
+  Only what RF433recv and the sketches of this archive need is provided.
+  - Time (micros(), millis()) is the real monotonic time of the process, plus
+    the sum of all durations passed to delay(): delay() does not sleep, it
+    makes time jump forward. This way a sketch that waits for seconds runs in
+    no time, while durations measured by the library remain meaningful.
+    arduino_host_freeze_time() stops the real time.
+  - There are no interrupts on the host. cli() and sei() do nothing, and
+    attachInterrupt() records the handler: it gets called by
+    arduino_host_set_pin(), that changes the (simulated) level of a pin.
+  - PROGMEM is ignored (everything lives in the same address space).
+  - Serial writes to the standard output.
+*/
+
+/*
+  Copyright 2021 Sébastien Millet
+
+  `RF433recv' is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  `RF433recv' is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program. If not, see
+  <https://www.gnu.org/licenses>.
+*/
+
+#ifndef _ARDUINO_HOST_H
+#define _ARDUINO_HOST_H
+
+#ifndef RF433RECV_HOST
+#define RF433RECV_HOST
+#endif
+
+    // Don't include <assert.h> here: RF433recv.cpp defines its own assert().
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW  0
+
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+#define strcpy_P(dst, src) strcpy((dst), (src))
+#define memcpy_P(dst, src, n) memcpy((dst), (src), (n))
+
+#define cli()
+#define sei()
+#define interrupts()
+#define noInterrupts()
+
+#define digitalPinToInterrupt(p) (p)
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+
+void attachInterrupt(uint8_t int_num, void (*func)(), int mode);
+void detachInterrupt(uint8_t int_num);
+
+    // Host-only: while time is frozen, it only goes forward with delay() and
+    // delayMicroseconds(), so that the durations measured by the library are
+    // exactly the ones 'waited'.
+void arduino_host_freeze_time(bool val);
+
+    // Host-only: set the level of a (simulated) pin, and if it changed, call
+    // the handler attached to it, if any.
+void arduino_host_set_pin(uint8_t pin, uint8_t val);
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class HostSerial {
+    public:
+        void begin(unsigned long) { }
+        int available() { return 0; }
+        int read() { return -1; }
+        void flush();
+
+        size_t print(const char *s);
+        size_t print(const __FlashStringHelper *s);
+        size_t print(char c);
+        size_t print(unsigned char n, int base = DEC);
+        size_t print(int n, int base = DEC);
+        size_t print(unsigned int n, int base = DEC);
+        size_t print(long n, int base = DEC);
+        size_t print(unsigned long n, int base = DEC);
+        size_t print(double d, int digits = 2);
+
+        size_t println();
+        template<typename T> size_t println(T v) {
+            size_t r = print(v);
+            return r + println();
+        }
+        template<typename T> size_t println(T v, int a) {
+            size_t r = print(v, a);
+            return r + println();
+        }
+};
+
+extern HostSerial Serial;
+
+void setup();
+void loop();
+
+#endif // _ARDUINO_HOST_H
+
+// vim: ts=4:sw=4:tw=80:et
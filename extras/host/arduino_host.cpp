@@ -0,0 +1,183 @@
+// arduino_host.cpp
+
+// Implementation of the Arduino stand-in, see Arduino.h in this folder.
+
+/*
+  Copyright 2021 Sébastien Millet
+
+  `RF433recv' is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  `RF433recv' is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program. If not, see
+  <https://www.gnu.org/licenses>.
+*/
+
+#include "Arduino.h"
+#include <time.h>
+
+HostSerial Serial;
+
+#define HOST_NB_PINS 64
+
+static uint8_t pin_levels[HOST_NB_PINS];
+static void (*pin_handlers[HOST_NB_PINS])();
+
+
+// * **** *********************************************************************
+// * Time *********************************************************************
+// * **** *********************************************************************
+
+    // Sum of the durations 'waited' by delay() and delayMicroseconds()
+static unsigned long long skipped_us = 0;
+
+static unsigned long long monotonic_us() {
+    static unsigned long long t0 = 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    unsigned long long t = (unsigned long long)ts.tv_sec * 1000000ULL
+                           + ts.tv_nsec / 1000;
+    if (!t0)
+        t0 = t;
+    return t - t0;
+}
+
+    // See arduino_host_freeze_time()
+static bool time_is_frozen = false;
+static unsigned long long frozen_at_us = 0;
+static unsigned long long frozen_total_us = 0;
+
+    // The real time elapsed, except while time is frozen
+static unsigned long long real_us() {
+    return (time_is_frozen ? frozen_at_us : monotonic_us()) - frozen_total_us;
+}
+
+void arduino_host_freeze_time(bool val) {
+    if (val == time_is_frozen)
+        return;
+    if (val)
+        frozen_at_us = monotonic_us();
+    else
+        frozen_total_us += monotonic_us() - frozen_at_us;
+    time_is_frozen = val;
+    if (val) {
+            // Time jumps to the next millisecond, so that what follows does
+            // not depend on when time got frozen.
+        const unsigned long long t = real_us() + skipped_us;
+        skipped_us += (1000 - t % 1000) % 1000;
+    }
+}
+
+    // Like on a 16 MHz AVR, micros() has a resolution of 4 microseconds.
+unsigned long micros() {
+    return (unsigned long)((real_us() + skipped_us) & ~3ULL);
+}
+
+unsigned long millis() {
+    return (unsigned long)((real_us() + skipped_us) / 1000);
+}
+
+void delay(unsigned long ms) {
+    skipped_us += (unsigned long long)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    skipped_us += us;
+}
+
+
+// * **** *********************************************************************
+// * Pins *********************************************************************
+// * **** *********************************************************************
+
+void pinMode(uint8_t, uint8_t) { }
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_NB_PINS ? pin_levels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < HOST_NB_PINS)
+        pin_levels[pin] = !!val;
+}
+
+void attachInterrupt(uint8_t int_num, void (*func)(), int) {
+    if (int_num < HOST_NB_PINS)
+        pin_handlers[int_num] = func;
+}
+
+void detachInterrupt(uint8_t int_num) {
+    if (int_num < HOST_NB_PINS)
+        pin_handlers[int_num] = nullptr;
+}
+
+void arduino_host_set_pin(uint8_t pin, uint8_t val) {
+    if (pin >= HOST_NB_PINS)
+        return;
+    val = !!val;
+    if (pin_levels[pin] == val)
+        return;
+    pin_levels[pin] = val;
+    if (pin_handlers[pin])
+        pin_handlers[pin]();
+}
+
+
+// * ****** *******************************************************************
+// * Serial *******************************************************************
+// * ****** *******************************************************************
+
+void HostSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HostSerial::print(const char *s) {
+    return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+size_t HostSerial::print(const __FlashStringHelper *s) {
+    return print(reinterpret_cast<const char *>(s));
+}
+
+size_t HostSerial::print(char c) {
+    return fputc(c, stdout) != EOF ? 1 : 0;
+}
+
+size_t HostSerial::print(unsigned char n, int base) {
+    return print((unsigned long)n, base);
+}
+
+size_t HostSerial::print(int n, int base) {
+    return print((long)n, base);
+}
+
+size_t HostSerial::print(unsigned int n, int base) {
+    return print((unsigned long)n, base);
+}
+
+size_t HostSerial::print(long n, int base) {
+    if (base == DEC)
+        return printf("%ld", n);
+    return print((unsigned long)n, base);
+}
+
+size_t HostSerial::print(unsigned long n, int base) {
+    return printf(base == HEX ? "%lX" : "%lu", n);
+}
+
+size_t HostSerial::print(double d, int digits) {
+    return printf("%.*f", digits, d);
+}
+
+size_t HostSerial::println() {
+    return print('\n');
+}
+
+// vim: ts=4:sw=4:tw=80:et
@@ -0,0 +1,33 @@
+// arduino_main.cpp
+
+// Entry point of a sketch compiled on the host: like the Arduino core does,
+// call setup() once, then loop() forever.
+// A sketch that wants to terminate on the host must call exit() by itself.
+
+/*
+  Copyright 2021 Sébastien Millet
+
+  `RF433recv' is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  `RF433recv' is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program. If not, see
+  <https://www.gnu.org/licenses>.
+*/
+
+#include "Arduino.h"
+
+int main() {
+    setup();
+    while (1)
+        loop();
+}
+
+// vim: ts=4:sw=4:tw=80:et
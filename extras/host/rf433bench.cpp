@@ -0,0 +1,338 @@
+// rf433bench.cpp
+
+// Micro-benchmark of the decoding engine (Receiver::process_signal(), as
+// called for every signal edge by the interrupt handler), on the host.
+//
+// Usage:
+//   rf433bench [-n NB_EDGES]
+//
+// For each automat (tribit, tribit_inverted, manchester), for 1, 12 and 64
+// registered receivers, for two kinds of input (noise, valid frames) and for
+// both APIs (see below), replays at least NB_EDGES edges (default: 2000000)
+// and outputs one CSV line:
+//
+//   variant,automat,receivers,input,api,edges,frames,ns_per_edge,edges_per_sec
+//
+// - variant is the build variant (see RF433BENCH_VARIANT below).
+// - api is 'edge' when signals are given one after the other to all receivers
+//   (RF_manager::replay()), and 'batch' when they are given by batches of 64
+//   to one receiver after the other (RF_manager::process_signals(), as done in
+//   deferred decoding mode).
+// - frames is the number of codes decoded (callbacks executed). With valid
+//   frames it must be equal to the number of frames replayed, as only one
+//   receiver out of all the registered ones can decode them.
+//
+// When more than one receiver is registered, the additional ones use the same
+// automat with other timings (scaled) and numbers of bits, so that they follow
+// (part of) the frames without ever decoding them.
+
+/*
+  Copyright 2021 Sébastien Millet
+
+  `RF433recv' is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  `RF433recv' is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program. If not, see
+  <https://www.gnu.org/licenses>.
+*/
+
+#include "RF433recv.h"
+#include "rf433capture.h"
+#include <Arduino.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef RF433BENCH_VARIANT
+#define RF433BENCH_VARIANT "default"
+#endif
+
+#define ARRAYSZ(a) (sizeof(a) / sizeof(*a))
+
+    // Number of frames (or noise durations) in the replayed buffer
+#define BENCH_NB_FRAMES     64
+#define BENCH_NOISE_LEN   4096
+#define BENCH_BUF_LEN     8192
+    // Number of signals decoded at a time with the 'batch' api
+#define BENCH_BATCH_LEN     64
+
+    // Durations are in microseconds
+#define NOISE_FRAME_HI     300
+
+struct bench_automat_t {
+    const char *name;
+    rf433_receiver_spec_t spec;
+};
+
+    // The reference receivers come from the test plan (reg2, reg1 and reg4).
+static const bench_automat_t automats[] = {
+    { "tribit",
+      { RFMOD_TRIBIT, 6976, 0, 0, 0, 562, 1258, 0, 0, 528, 6996, 16 } },
+    { "tribit_inverted",
+      { RFMOD_TRIBIT_INVERTED, 23936, 0, 0, 684, 684, 1360, 0, 0, 676,
+        23928, 12 } },
+    { "manchester",
+      { RFMOD_MANCHESTER, 10000, 0, 0, 0, 1166, 0, 0, 0, 1164, 10000, 16 } }
+};
+
+static const int nb_receivers[] = { 1, 12, 64 };
+
+static unsigned long nb_frames_received;
+
+static void callback(const BitVector *) {
+    ++nb_frames_received;
+}
+
+static uint32_t xorshift_state = 2463534242UL;
+
+static uint32_t xorshift32() {
+    uint32_t x = xorshift_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return xorshift_state = x;
+}
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+// * ****************** *******************************************************
+// * Frames synthesizer *******************************************************
+// * ****************** *******************************************************
+
+// Frames are written so that they start with a low level (the initialization
+// sequence) and end with a high level, so that they can be concatenated.
+
+static size_t push(uint16_t *buf, size_t len, uint16_t d) {
+    if (len >= BENCH_BUF_LEN) {
+        fprintf(stderr, "bench buffer too small\n");
+        exit(1);
+    }
+    buf[len] = d;
+    return len + 1;
+}
+
+static size_t synth_tribit(const rf433_receiver_spec_t *s, uint32_t code,
+        uint16_t *buf, size_t len) {
+    uint16_t hi_short = (s->hi_short ? s->hi_short : s->lo_short);
+    uint16_t hi_long = (s->hi_long ? s->hi_long : s->lo_long);
+    len = push(buf, len, s->initseq);
+    for (int i = s->nb_bits - 1; i >= 0; --i) {
+        if ((code >> i) & 1) {
+            len = push(buf, len, s->lo_long);
+            len = push(buf, len, hi_short);
+        } else {
+            len = push(buf, len, s->lo_short);
+            len = push(buf, len, hi_long);
+        }
+    }
+    len = push(buf, len, s->lo_last ? s->lo_last : s->lo_short);
+    len = push(buf, len, s->sep);
+    return push(buf, len, NOISE_FRAME_HI);
+}
+
+static size_t synth_tribit_inverted(const rf433_receiver_spec_t *s,
+        uint32_t code, uint16_t *buf, size_t len) {
+    uint16_t hi_short = (s->hi_short ? s->hi_short : s->lo_short);
+    uint16_t hi_long = (s->hi_long ? s->hi_long : s->lo_long);
+    len = push(buf, len, s->initseq);
+    len = push(buf, len, s->first_lo_ign);
+    for (int i = s->nb_bits - 1; i >= 0; --i) {
+        if ((code >> i) & 1) {
+            len = push(buf, len, hi_long);
+            len = push(buf, len, s->lo_short);
+        } else {
+            len = push(buf, len, hi_short);
+            len = push(buf, len, s->lo_long);
+        }
+    }
+    len = push(buf, len, s->sep);
+    return push(buf, len, NOISE_FRAME_HI);
+}
+
+    // Works with half-bit levels (1 for high, 0 for low), that are then merged
+    // into durations.
+static size_t synth_manchester(const rf433_receiver_spec_t *s, uint32_t code,
+        uint16_t *buf, size_t len) {
+    byte half_bits[2 + 2 * 32];
+    int n = 0;
+    half_bits[n++] = 1;
+    half_bits[n++] = 0;
+    for (int i = s->nb_bits - 1; i >= 0; --i) {
+        byte b = (code >> i) & 1;
+        half_bits[n++] = !b;
+        half_bits[n++] = b;
+    }
+
+    len = push(buf, len, s->initseq);
+    int i = 0;
+    while (i < n) {
+        int j = i + 1;
+        while (j < n && half_bits[j] == half_bits[i])
+            ++j;
+        if (j == n && !half_bits[i])
+            break;
+        len = push(buf, len, s->lo_short * (j - i));
+        i = j;
+    }
+    len = push(buf, len, s->sep);
+    return push(buf, len, NOISE_FRAME_HI);
+}
+
+static size_t synth_frames(const rf433_receiver_spec_t *s, uint16_t *buf) {
+    size_t len = 0;
+    for (int i = 0; i < BENCH_NB_FRAMES; ++i) {
+        uint32_t code = xorshift32();
+        if (s->nb_bits < 32)
+            code &= (1UL << s->nb_bits) - 1;
+        if (s->mod == RFMOD_TRIBIT)
+            len = synth_tribit(s, code, buf, len);
+        else if (s->mod == RFMOD_TRIBIT_INVERTED)
+            len = synth_tribit_inverted(s, code, buf, len);
+        else
+            len = synth_manchester(s, code, buf, len);
+    }
+    return len;
+}
+
+    // Mostly durations that look like data, and a few longer ones.
+static size_t synth_noise(uint16_t *buf) {
+    for (size_t i = 0; i < BENCH_NOISE_LEN; ++i) {
+        uint32_t r = xorshift32();
+        if (r % 10)
+            buf[i] = 100 + (r >> 8) % 2900;
+        else
+            buf[i] = 3000 + (r >> 8) % 27000;
+    }
+    return BENCH_NOISE_LEN;
+}
+
+
+// * ***** ********************************************************************
+// * Bench ********************************************************************
+// * ***** ********************************************************************
+
+static uint16_t scale(uint16_t v, unsigned int pct) {
+    unsigned long r = (unsigned long)v * pct / 100;
+    return r > 65535 ? 65535 : r;
+}
+
+static void register_receivers(RF_manager *rf,
+        const rf433_receiver_spec_t *s, int n) {
+    static const unsigned int scales[] = { 50, 70, 140, 200 };
+    for (int i = 0; i < n; ++i) {
+        unsigned int pct = (i ? scales[i % ARRAYSZ(scales)] : 100);
+        byte nb_bits = s->nb_bits + (i ? 1 + i / ARRAYSZ(scales) : 0);
+        rf->register_Receiver(s->mod, scale(s->initseq, pct),
+                scale(s->lo_prefix, pct), scale(s->hi_prefix, pct),
+                scale(s->first_lo_ign, pct), scale(s->lo_short, pct),
+                scale(s->lo_long, pct), scale(s->hi_short, pct),
+                scale(s->hi_long, pct), scale(s->lo_last, pct),
+                scale(s->sep, pct), nb_bits, callback, 0);
+    }
+}
+
+    // Same as rf->replay(durations, len, 0), by batches of BENCH_BATCH_LEN
+    // signals given to RF_manager::process_signals().
+    // Durations get compacted, as the interrupt handler would do.
+static void replay_batch(RF_manager *rf, const uint16_t *durations,
+        size_t len) {
+    static sbuf_entry_t edges[BENCH_BUF_LEN];
+    for (size_t i = 0; i < len; ++i) {
+        edges[i].signal_val = !(i & 1);
+        edges[i].compact_signal_duration = compact(durations[i]);
+    }
+    for (size_t i = 0; i < len; i += BENCH_BATCH_LEN) {
+        rf->process_signals(edges + i,
+                len - i < BENCH_BATCH_LEN ? len - i : BENCH_BATCH_LEN);
+    }
+}
+
+static void bench(const bench_automat_t *a, int n, bool noise, bool batch,
+        unsigned long target_edges) {
+    static uint16_t buf[BENCH_BUF_LEN];
+    size_t len = (noise ? synth_noise(buf) : synth_frames(&a->spec, buf));
+
+    RF_manager *rf = new RF_manager(2);
+#ifdef RF433RECV_TEST_STRICT
+    rf->set_decode_mood(DecodeMood::STRICT);
+#endif
+    register_receivers(rf, &a->spec, n);
+
+        // Warm up (and check the frames are decoded)
+    nb_frames_received = 0;
+    if (batch)
+        replay_batch(rf, buf, len);
+    else
+        rf->replay(buf, len, 0);
+    if (!noise && nb_frames_received != BENCH_NB_FRAMES) {
+        fprintf(stderr, "%s: %d receiver(s): %lu frame(s) decoded, "
+                "expected %d\n", a->name, n, nb_frames_received,
+                BENCH_NB_FRAMES);
+        exit(1);
+    }
+
+    unsigned long nb_runs = (target_edges + len - 1) / len;
+    nb_frames_received = 0;
+    double t0 = now_ns();
+    for (unsigned long i = 0; i < nb_runs; ++i) {
+        if (batch)
+            replay_batch(rf, buf, len);
+        else
+            rf->replay(buf, len, 0);
+    }
+    double t1 = now_ns();
+
+    unsigned long edges = nb_runs * len;
+    double ns_per_edge = (t1 - t0) / edges;
+    printf("%s,%s,%d,%s,%s,%lu,%lu,%.1f,%.0f\n", RF433BENCH_VARIANT, a->name,
+            n, noise ? "noise" : "frames", batch ? "batch" : "edge", edges,
+            nb_frames_received, ns_per_edge, 1e9 / ns_per_edge);
+    fflush(stdout);
+
+    delete rf;
+}
+
+int main(int argc, char **argv) {
+    unsigned long target_edges = 2000000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n':
+            target_edges = strtoul(optarg, nullptr, 10);
+            break;
+        default:
+            fprintf(stderr, "Usage:\n  rf433bench [-n NB_EDGES]\n");
+            return 1;
+        }
+    }
+
+    printf("variant,automat,receivers,input,api,edges,frames,ns_per_edge,"
+            "edges_per_sec\n");
+    for (size_t i = 0; i < ARRAYSZ(automats); ++i) {
+        for (size_t j = 0; j < ARRAYSZ(nb_receivers); ++j) {
+            for (int batch = 0; batch <= 1; ++batch) {
+                bench(&automats[i], nb_receivers[j], true, batch,
+                        target_edges);
+                bench(&automats[i], nb_receivers[j], false, batch,
+                        target_edges);
+            }
+        }
+    }
+
+    return 0;
+}
+
+// vim: ts=4:sw=4:tw=80:et
@@ -0,0 +1,170 @@
+// rf433capture.cpp
+
+// See rf433capture.h
+
+/*
+  Copyright 2021 Sébastien Millet
+
+  `RF433recv' is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  `RF433recv' is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program. If not, see
+  <https://www.gnu.org/licenses>.
+*/
+
+#include "rf433capture.h"
+#include <ctype.h>
+
+#define ARRAYSZ(a) (sizeof(a) / sizeof(*a))
+
+    // Durations are replayed by chunks of this size.
+#define CAPTURE_CHUNK 4096
+
+static const struct {
+    const char *name;
+    byte mod;
+} mod_names[] = {
+    { "TRIBIT_INVERTED", RFMOD_TRIBIT_INVERTED },
+    { "TRIBIT",          RFMOD_TRIBIT },
+    { "MANCHESTER",      RFMOD_MANCHESTER }
+};
+
+static bool parse_number(const char **pp, unsigned long max,
+        unsigned long *v) {
+    const char *p = *pp + strspn(*pp, " \t");
+    char *end;
+    if (!isdigit((unsigned char)*p))
+        return false;
+    *v = strtoul(p, &end, 10);
+    if (*v > max)
+        return false;
+    *pp = end + strspn(end, " \t");
+    return true;
+}
+
+    // Returns nullptr if mod is unknown.
+const char *rf433_mod_name(byte mod) {
+    for (size_t i = 0; i < ARRAYSZ(mod_names); ++i) {
+        if (mod_names[i].mod == mod)
+            return mod_names[i].name;
+    }
+    return nullptr;
+}
+
+bool rf433_parse_receiver_spec(const char *spec, rf433_receiver_spec_t *r) {
+    const char *p = spec + strspn(spec, " \t");
+
+    unsigned long mod = 255;
+    for (size_t i = 0; i < ARRAYSZ(mod_names); ++i) {
+        size_t l = strlen(mod_names[i].name);
+        if (!strncmp(p, mod_names[i].name, l)) {
+            mod = mod_names[i].mod;
+            p += l;
+            break;
+        }
+    }
+    if (mod == 255 && !parse_number(&p, RFMOD_MANCHESTER, &mod))
+        return false;
+    r->mod = mod;
+
+    uint16_t *fields[] = {
+        &r->initseq, &r->lo_prefix, &r->hi_prefix, &r->first_lo_ign,
+        &r->lo_short, &r->lo_long, &r->hi_short, &r->hi_long, &r->lo_last,
+        &r->sep
+    };
+    unsigned long v;
+    for (size_t i = 0; i < ARRAYSZ(fields); ++i) {
+        p += strspn(p, " \t");
+        if (*p++ != ',' || !parse_number(&p, 65535, &v))
+            return false;
+        *fields[i] = v;
+    }
+    p += strspn(p, " \t");
+    if (*p++ != ',' || !parse_number(&p, 255, &v) || !v)
+        return false;
+    r->nb_bits = v;
+
+    return !*p || *p == '\n' || *p == '\r' || *p == '#';
+}
+
+long rf433_read_capture(FILE *f, uint16_t *buf, size_t bufsz) {
+    size_t n = 0;
+    int c;
+    while (n < bufsz && (c = getc(f)) != EOF) {
+        if (c == '/') {
+            if (getc(f) != '/')
+                return -1;
+            c = '#';
+        }
+        if (c == '#') {
+            while ((c = getc(f)) != EOF && c != '\n')
+                ;
+            continue;
+        }
+        if (isdigit(c)) {
+            unsigned long v = 0;
+            do {
+                v = v * 10 + (c - '0');
+                if (v > 65535)
+                    return -1;
+            } while ((c = getc(f)) != EOF && isdigit(c));
+            if (c != EOF)
+                ungetc(c, f);
+            buf[n++] = v;
+            continue;
+        }
+        if (!isspace(c) && c != ',')
+            return -1;
+    }
+    return n;
+}
+
+bool rf433_replay_capture(RF_manager *rf, FILE *f, byte first_level) {
+    static uint16_t buf[CAPTURE_CHUNK];
+    long n;
+    while ((n = rf433_read_capture(f, buf, ARRAYSZ(buf))) > 0) {
+        rf->replay(buf, n, first_level);
+            // Chunks are of even size, except the last one, so the level of
+            // the first duration remains the same from one chunk to the next.
+        static_assert(!(CAPTURE_CHUNK & 1), "CAPTURE_CHUNK must be even");
+    }
+    return n == 0;
+}
+
+    // The level given alongside a duration is the level of the signal that
+    // follows it (see RF_manager::replay()).
+CaptureEdgeSource::CaptureEdgeSource(FILE *arg_f, byte first_level):
+        f(arg_f),
+        level(first_level),
+        duration(0),
+        is_invalid(false),
+        handler(nullptr) {
+}
+
+bool CaptureEdgeSource::read_edge(uint16_t *arg_duration, byte *arg_level) {
+    *arg_duration = duration;
+    *arg_level = level;
+    return true;
+}
+
+bool CaptureEdgeSource::feed() {
+    long n = rf433_read_capture(f, &duration, 1);
+    if (n <= 0) {
+        is_invalid = (n < 0);
+        return false;
+    }
+    level = !level;
+    if (handler)
+        handler();
+    return true;
+}
+
+// vim: ts=4:sw=4:tw=80:et
@@ -0,0 +1,86 @@
+// rf433capture.h
+
+// Host-side helpers to read capture files and receiver specifications.
+// See rf433replay.cpp for the format of both.
+
+/*
+  Copyright 2021 Sébastien Millet
+
+  `RF433recv' is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  `RF433recv' is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program. If not, see
+  <https://www.gnu.org/licenses>.
+*/
+
+#ifndef _RF433CAPTURE_H
+#define _RF433CAPTURE_H
+
+#include "RF433recv.h"
+#include <stdio.h>
+
+struct rf433_receiver_spec_t {
+    byte mod;
+    uint16_t initseq;
+    uint16_t lo_prefix;
+    uint16_t hi_prefix;
+    uint16_t first_lo_ign;
+    uint16_t lo_short;
+    uint16_t lo_long;
+    uint16_t hi_short;
+    uint16_t hi_long;
+    uint16_t lo_last;
+    uint16_t sep;
+    byte nb_bits;
+};
+
+bool rf433_parse_receiver_spec(const char *spec, rf433_receiver_spec_t *r);
+const char *rf433_mod_name(byte mod);
+
+    // Reads durations from f and returns them in buf (at most bufsz of them).
+    // Returns the number of durations read, 0 at end of file, and -1 if the
+    // content of f is invalid.
+long rf433_read_capture(FILE *f, uint16_t *buf, size_t bufsz);
+
+    // Streams the whole content of f through rf->replay().
+    // Returns false if the content of f is invalid.
+bool rf433_replay_capture(RF_manager *rf, FILE *f, byte first_level);
+
+    // Edge source reading durations from a capture file: each call to feed()
+    // reads the next duration and calls the interrupt handler attached, as
+    // the edge would, so that the durations go through the same path as on a
+    // board (buffer of signals, decoding in the interrupt handler).
+class CaptureEdgeSource: public EdgeSource {
+    private:
+        FILE *f;
+        byte level;
+        uint16_t duration;
+        bool is_invalid;
+        rf_handler_t handler;
+
+    public:
+        CaptureEdgeSource(FILE *arg_f, byte first_level);
+
+        void attach(rf_handler_t arg_handler) override {
+            handler = arg_handler;
+        }
+        void detach() override { handler = nullptr; }
+        bool read_edge(uint16_t *arg_duration, byte *arg_level) override;
+
+            // Returns false once the whole file is read (or if its content is
+            // invalid, see get_is_invalid()).
+        bool feed();
+        bool get_is_invalid() const { return is_invalid; }
+};
+
+#endif // _RF433CAPTURE_H
+
+// vim: ts=4:sw=4:tw=80:et
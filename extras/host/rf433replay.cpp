@@ -0,0 +1,578 @@
+// rf433replay.cpp
+
+// Replays recorded durations (capture files) through RF433recv receivers, on
+// the host, as fast as possible.
+//
+// Usage:
+//   rf433replay [-l LEVEL] [-L] [-c MIN] [-C] [-w TIMEOUT] [-S]
+//               [-d DELAY | -E | -g MODE] [-m MOOD]
+//               ((-r SPEC | -R FILE) [-k CODE]...)... [CAPTURE]...
+//   rf433replay [-l LEVEL] -D NB [CAPTURE]...
+//
+//   -r SPEC   Register a receiver. SPEC is made of the arguments of
+//             register_Receiver(), separated by commas, in the same order:
+//               mod,initseq,lo_prefix,hi_prefix,first_lo_ign,lo_short,
+//               lo_long,hi_short,hi_long,lo_last,sep,nb_bits
+//             mod is TRIBIT, TRIBIT_INVERTED, MANCHESTER or its numeric value.
+//   -R FILE   Register one receiver per line of FILE (same format as SPEC).
+//   -k CODE   Register a callback on the last receiver registered (see
+//             RF_manager::register_callback()), for the code CODE, given as
+//             NB_BITS:HEX (like 12:0751), or for any code if CODE is 'any'.
+//             It outputs the code as:
+//               callback callback_number: nb_bits: [hex bytes]
+//             where callback_number is the rank of the option -k, starting
+//             from 1. With the callback that every receiver gets, this shows
+//             the order in which the callbacks of a code get executed.
+//   -m MOOD   Decode mood of the receivers registered afterwards (see
+//             RF_manager::set_decode_mood()): laxist, strict, or the
+//             tolerance (1 to 100) of DecodeMood::CUSTOM. Default: laxist
+//             (strict with RF433RECV_TEST_STRICT).
+//   -l LEVEL  Level (0 or 1) of the first duration of each capture file.
+//             Default: 1.
+//   -L        Once done, output latencies statistics (requires
+//             DEBUG_LATENCIES, see RF433recv.h). As durations are replayed as
+//             fast as possible, the time between the end of a code and the
+//             callbacks is the decoding overhead.
+//   -c MIN    After each capture file, recalibrate the receivers with the
+//             durations measured in at least MIN codes (requires
+//             RF433RECV_CALIBRATION, see RF_manager::recalibrate()).
+//   -C        Once done, output the durations measured by each receiver
+//             (requires RF433RECV_CALIBRATION).
+//   -S        Once done, output the statistics of the occupancy of the band,
+//             summed over the windows recorded (requires
+//             RF433RECV_CHANNEL_STATS, see RF_manager::get_channel_stats()).
+//             Time only goes forward as durations are replayed with -g.
+//   -D NB     Record the first NB durations, and output the receiver
+//             specification worked out from them (requires
+//             RF433RECV_DISCOVERY, see RF_manager::discover()). No receiver
+//             needs to be registered.
+//   -w TIMEOUT
+//             Execute the callbacks once the band is free, without blocking
+//             (see RF_manager::set_opt_wait_free_433(), with async set). 0
+//             means no timeout.
+//   -d DELAY  Antenna diversity: register the receivers on a second
+//             RF_manager too, give it each duration right after the first
+//             one, and execute the callbacks of a code once if both get it
+//             within DELAY milliseconds (see RF_manager::set_dedup_delay()).
+//             Must come before -r and -R.
+//   -E        Feed the durations through an EdgeSource (see
+//             CaptureEdgeSource in rf433capture.h), that is, through the
+//             interrupt handler, as on a board, instead of
+//             RF_manager::replay().
+//   -g MODE   Feed the durations through the (simulated) input pin, read by
+//             GpioEdgeSource in LevelMode MODE (read or toggle). Outputs
+//             the number of level desynchronizations on the standard error,
+//             if any.
+//
+// A capture file (or the standard input, if no file is given) contains
+// durations in microseconds, separated by spaces, commas or new lines. Levels
+// alternate from one duration to the next. '#' and '//' start a comment that
+// ends with the line.
+//
+// Each decoded code is output as:
+//   frame_number: receiver_number: nb_bits: [hex bytes]
+// where receiver_number is the rank of registration of the receiver, starting
+// from 1.
+
+/*
+  Copyright 2021 Sébastien Millet
+
+  `RF433recv' is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  `RF433recv' is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program. If not, see
+  <https://www.gnu.org/licenses>.
+*/
+
+#include "RF433recv.h"
+#include "rf433capture.h"
+#include <Arduino.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#define REPLAY_MAX_RECEIVERS 64
+#define REPLAY_MAX_CODE_CALLBACKS 16
+
+static RF_manager rf(2);
+    // The second antenna, see -d
+static RF_manager *rf2 = nullptr;
+
+static unsigned long frame_number = 0;
+static int current_receiver_number;
+
+    // The callback has no way to know which receiver called it, hence one
+    // callback per receiver, dispatching to the common one.
+static void callback(int receiver_number, const BitVector *recorded) {
+    ++frame_number;
+    char *printed_code = recorded->to_str();
+    printf("%lu: %d: %d: [%s]\n", frame_number, receiver_number + 1,
+            recorded->get_nb_bits(), printed_code ? printed_code : "");
+    if (printed_code)
+        free(printed_code);
+}
+
+    // -k
+static void code_callback(int callback_number, const BitVector *recorded) {
+    char *printed_code = recorded->to_str();
+    printf("callback %d: %d: [%s]\n", callback_number + 1,
+            recorded->get_nb_bits(), printed_code ? printed_code : "");
+    if (printed_code)
+        free(printed_code);
+}
+
+typedef void (*callback_func_t)(const BitVector *recorded);
+typedef void (*numbered_callback_func_t)(int n, const BitVector *recorded);
+
+template<numbered_callback_func_t FUNC, int N>
+static void callback_n(const BitVector *recorded) {
+    FUNC(N, recorded);
+}
+
+template<numbered_callback_func_t FUNC, int N> struct CallbackTable {
+    static void fill(callback_func_t *t) {
+        t[N - 1] = &callback_n<FUNC, N - 1>;
+        CallbackTable<FUNC, N - 1>::fill(t);
+    }
+};
+template<numbered_callback_func_t FUNC> struct CallbackTable<FUNC, 0> {
+    static void fill(callback_func_t *) { }
+};
+
+static callback_func_t callbacks[REPLAY_MAX_RECEIVERS];
+static callback_func_t code_callbacks[REPLAY_MAX_CODE_CALLBACKS];
+static int current_code_callback_number;
+
+static void usage() {
+    fprintf(stderr,
+        "Usage:\n"
+        "  rf433replay [-l LEVEL] [-L] [-c MIN] [-C] [-w TIMEOUT] [-S]\n"
+        "              [-d DELAY | -E | -g MODE] [-m MOOD]\n"
+        "              ((-r SPEC | -R FILE) [-k CODE]...)... [CAPTURE]...\n"
+        "  rf433replay [-l LEVEL] -D NB [CAPTURE]...\n");
+    exit(1);
+}
+
+static bool register_receiver(const char *spec) {
+    if (current_receiver_number >= REPLAY_MAX_RECEIVERS) {
+        fprintf(stderr, "too many receivers (max: %d)\n",
+                REPLAY_MAX_RECEIVERS);
+        return false;
+    }
+
+    rf433_receiver_spec_t r;
+    if (!rf433_parse_receiver_spec(spec, &r)) {
+        fprintf(stderr, "invalid receiver specification: '%s'\n", spec);
+        return false;
+    }
+
+    if (!rf.register_Receiver(r.mod, r.initseq, r.lo_prefix, r.hi_prefix,
+                r.first_lo_ign, r.lo_short, r.lo_long, r.hi_short, r.hi_long,
+                r.lo_last, r.sep, r.nb_bits,
+                callbacks[current_receiver_number], 0)
+            || (rf2 && !rf2->register_Receiver(r.mod, r.initseq, r.lo_prefix,
+                    r.hi_prefix, r.first_lo_ign, r.lo_short, r.lo_long,
+                    r.hi_short, r.hi_long, r.lo_last, r.sep, r.nb_bits,
+                    callbacks[current_receiver_number], 0))) {
+        fprintf(stderr, "can't register the receiver: '%s'\n", spec);
+        return false;
+    }
+    ++current_receiver_number;
+    return true;
+}
+
+    // Parses NB_BITS:HEX (HEX being the bytes of the code, the most significant
+    // first, as output by BitVector::to_str(), with or without spaces).
+    // Returns nullptr if code is invalid.
+static BitVector *parse_code(const char *code) {
+    char *end;
+    const long nb_bits = strtol(code, &end, 10);
+    if (nb_bits < 1 || nb_bits > 255 || *end != ':')
+        return nullptr;
+    const int nb_bytes = (nb_bits + 7) >> 3;
+    byte bytes[32];
+    int n = 0;
+    for (const char *p = end + 1; *p; ++p) {
+        if (*p == ' ')
+            continue;
+        if (!isxdigit(*p) || !isxdigit(p[1]) || n >= nb_bytes)
+            return nullptr;
+        const char hex[3] = { p[0], p[1], '\0' };
+        bytes[n++] = strtol(hex, nullptr, 16);
+        ++p;
+    }
+    if (n != nb_bytes)
+        return nullptr;
+
+    BitVector *bv = new BitVector(nb_bits);
+    for (int i = nb_bits - 1; i >= 0; --i)
+        bv->add_bit((bytes[n - 1 - (i >> 3)] >> (i & 0x07)) & 0x01);
+    return bv;
+}
+
+static bool register_code_callback(const char *code) {
+    if (!current_receiver_number) {
+        fprintf(stderr, "-k must come after a receiver gets registered\n");
+        return false;
+    }
+    if (current_code_callback_number >= REPLAY_MAX_CODE_CALLBACKS) {
+        fprintf(stderr, "too many callbacks (max: %d)\n",
+                REPLAY_MAX_CODE_CALLBACKS);
+        return false;
+    }
+    const BitVector *pcode = nullptr;
+    if (strcmp(code, "any") && !(pcode = parse_code(code))) {
+        fprintf(stderr, "invalid code: '%s'\n", code);
+        return false;
+    }
+    const callback_func_t func = code_callbacks[current_code_callback_number];
+    if (!rf.register_callback(func, 0, pcode)
+            || (rf2 && !rf2->register_callback(func, 0, pcode))) {
+        fprintf(stderr, "can't register the callback of '%s'\n", code);
+        return false;
+    }
+    ++current_code_callback_number;
+    return true;
+}
+
+#ifdef RF433RECV_CALIBRATION
+static void output_calibration() {
+    static const char *const names[CAL_NB_CLASSES] = {
+        "lo_prefix", "hi_prefix", "first_lo_ign", "lo_short", "lo_long",
+        "hi_short", "hi_long", "lo_last"
+    };
+    int num = 1;
+    for (Receiver *ptr_rec = rf.get_head(); ptr_rec;
+            ptr_rec = ptr_rec->get_next()) {
+        printf("calibration: %d:", num++);
+        for (byte ec = EC_LO_PREFIX; ec <= EC_LO_LAST; ++ec) {
+            if (ptr_rec->get_calibration_nb_codes(ec)) {
+                printf(" %s=%u(%u)", names[ec - EC_LO_PREFIX],
+                        ptr_rec->get_calibrated_duration(ec),
+                        ptr_rec->get_calibration_nb_codes(ec));
+            }
+        }
+        printf("\n");
+    }
+}
+#endif
+
+#ifdef RF433RECV_CHANNEL_STATS
+static void output_channel_stats() {
+    channel_stats_t st;
+    byte nb = rf.get_channel_stats(&st, RF433RECV_STATS_NB_WINDOWS);
+    printf("channel stats: windows=%u duration_ms=%lu\n", nb,
+            (unsigned long)st.duration_ms);
+    printf("channel stats: edges=%lu (%lu/s)\n", (unsigned long)st.edges,
+            (unsigned long)st.get_edges_per_second());
+    printf("channel stats: plausible=%lu (%u%%)\n",
+            (unsigned long)st.plausible, st.get_plausible_percent());
+    printf("channel stats: busy_us=%lu (%u%%)\n", (unsigned long)st.busy_us,
+            st.get_busy_percent());
+}
+#endif
+
+#ifdef RF433RECV_DISCOVERY
+    // Output in the format of a receiver specification (see -r)
+static bool output_discovery() {
+    automat_args_t a;
+    if (!RF_manager::discover(&a)) {
+        fprintf(stderr, "no protocol found\n");
+        return false;
+    }
+    printf("%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", rf433_mod_name(a.mod),
+            a.initseq, a.lo_prefix, a.hi_prefix, a.first_lo_ign, a.lo_short,
+            a.lo_long, a.hi_short, a.hi_long, a.lo_last, a.sep, a.nb_bits);
+    return true;
+}
+#endif
+
+static bool register_receivers_from_file(const char *fname) {
+    FILE *f = fopen(fname, "r");
+    if (!f) {
+        perror(fname);
+        return false;
+    }
+    bool ret = true;
+    char line[256];
+    while (ret && fgets(line, sizeof(line), f)) {
+        char *p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || !*p)
+            continue;
+        ret = register_receiver(p);
+    }
+    fclose(f);
+    return ret;
+}
+
+    // Like rf433_replay_capture(), giving each duration to rf, then to rf2.
+static bool replay_capture_diversity(FILE *f, byte first_level) {
+    uint16_t d;
+    byte level = first_level;
+    long n;
+    while ((n = rf433_read_capture(f, &d, 1)) > 0) {
+        rf.replay(&d, 1, level);
+        rf2->replay(&d, 1, level);
+        level = !level;
+    }
+    return n == 0;
+}
+
+    // -m
+#ifdef RF433RECV_TEST_STRICT
+static DecodeMood opt_mood = DecodeMood::STRICT;
+#else
+static DecodeMood opt_mood = DecodeMood::LAXIST;
+#endif
+static byte opt_tolerance = 0;
+
+static bool parse_mood(const char *s) {
+    if (!strcmp(s, "laxist")) {
+        opt_mood = DecodeMood::LAXIST;
+        opt_tolerance = 0;
+    } else if (!strcmp(s, "strict")) {
+        opt_mood = DecodeMood::STRICT;
+        opt_tolerance = 0;
+    } else {
+        char *end;
+        long t = strtol(s, &end, 10);
+        if (*end || t < 1 || t > 100)
+            return false;
+        opt_mood = DecodeMood::CUSTOM;
+        opt_tolerance = t;
+    }
+    rf.set_decode_mood(opt_mood, opt_tolerance);
+    if (rf2)
+        rf2->set_decode_mood(opt_mood, opt_tolerance);
+    return true;
+}
+
+    // -E
+static bool opt_edge_source = false;
+
+static bool replay_capture_edges(FILE *f, byte first_level) {
+    CaptureEdgeSource src(f, first_level);
+    rf.set_edge_source(&src);
+    rf.activate_interrupts_handler();
+    while (src.feed())
+        rf.do_events();
+    rf.inactivate_interrupts_handler();
+    rf.set_edge_source(nullptr);
+    return !src.get_is_invalid();
+}
+
+    // -g
+static bool opt_gpio = false;
+static LevelMode opt_level_mode = LevelMode::READ;
+
+static bool replay_capture_gpio(FILE *f, byte first_level) {
+    const byte pin = rf.get_pin_input_num();
+    byte level = first_level;
+    arduino_host_set_pin(pin, level);
+    rf.get_gpio_source()->set_level_mode(opt_level_mode);
+        // So that micros() measures the durations waited below, and nothing
+        // else.
+    arduino_host_freeze_time(true);
+#ifdef RF433RECV_CHANNEL_STATS
+    rf.reset_channel_stats();
+#endif
+    rf.activate_interrupts_handler();
+    uint16_t d;
+    long n;
+    while ((n = rf433_read_capture(f, &d, 1)) > 0) {
+        delayMicroseconds(d);
+        level = !level;
+        arduino_host_set_pin(pin, level);
+        rf.do_events();
+    }
+    rf.inactivate_interrupts_handler();
+    arduino_host_freeze_time(false);
+    uint32_t desyncs = rf.get_gpio_source()->get_level_desyncs();
+    if (desyncs)
+        fprintf(stderr, "level desynchronizations: %lu\n",
+                (unsigned long)desyncs);
+    return n == 0;
+}
+
+static bool replay_capture(FILE *f, byte first_level) {
+    if (opt_edge_source)
+        return replay_capture_edges(f, first_level);
+    if (opt_gpio)
+        return replay_capture_gpio(f, first_level);
+    return rf2 ? replay_capture_diversity(f, first_level)
+        : rf433_replay_capture(&rf, f, first_level);
+}
+
+int main(int argc, char **argv) {
+    byte first_level = 1;
+    bool output_latencies = false;
+    int recalibrate_min_codes = 0;
+    bool output_calibration_is_set = false;
+    bool output_channel_stats_is_set = false;
+    int discovery_nb = 0;
+    long wait_free_timeout = -1;
+
+    CallbackTable<callback, REPLAY_MAX_RECEIVERS>::fill(callbacks);
+    CallbackTable<code_callback, REPLAY_MAX_CODE_CALLBACKS>::fill(
+            code_callbacks);
+    rf.set_decode_mood(opt_mood, opt_tolerance);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "l:Lc:Cw:SD:d:Eg:m:r:R:k:")) != -1) {
+        switch (opt) {
+        case 'l':
+            first_level = !!atoi(optarg);
+            break;
+        case 'L':
+#ifndef DEBUG_LATENCIES
+            fprintf(stderr, "-L requires DEBUG_LATENCIES\n");
+            return 1;
+#endif
+            output_latencies = true;
+            break;
+        case 'c':
+        case 'C':
+#ifndef RF433RECV_CALIBRATION
+            fprintf(stderr, "-%c requires RF433RECV_CALIBRATION\n", opt);
+            return 1;
+#endif
+            if (opt == 'C')
+                output_calibration_is_set = true;
+            else if ((recalibrate_min_codes = atoi(optarg)) < 1)
+                usage();
+            break;
+        case 'w':
+            if ((wait_free_timeout = atol(optarg)) < 0)
+                usage();
+            break;
+        case 'S':
+#ifndef RF433RECV_CHANNEL_STATS
+            fprintf(stderr, "-S requires RF433RECV_CHANNEL_STATS\n");
+            return 1;
+#endif
+            output_channel_stats_is_set = true;
+            break;
+        case 'D':
+#ifndef RF433RECV_DISCOVERY
+            fprintf(stderr, "-D requires RF433RECV_DISCOVERY\n");
+            return 1;
+#else
+            discovery_nb = atoi(optarg);
+            if (discovery_nb < 1 || discovery_nb > 65535
+                    || !rf.start_discovery(discovery_nb)) {
+                usage();
+            }
+            break;
+#endif
+        case 'd':
+#if RF433RECV_MAX_MANAGERS < 2
+            fprintf(stderr, "-d requires RF433RECV_MAX_MANAGERS >= 2\n");
+            return 1;
+#endif
+            if (current_receiver_number || rf2 || opt_edge_source || opt_gpio)
+                usage();
+            rf2 = new RF_manager(3);
+            rf2->set_decode_mood(opt_mood, opt_tolerance);
+            RF_manager::set_dedup_delay(atol(optarg));
+            break;
+        case 'E':
+            if (rf2 || opt_gpio)
+                usage();
+            opt_edge_source = true;
+            break;
+        case 'g':
+            if (rf2 || opt_edge_source)
+                usage();
+            if (!strcmp(optarg, "read"))
+                opt_level_mode = LevelMode::READ;
+            else if (!strcmp(optarg, "toggle"))
+                opt_level_mode = LevelMode::TOGGLE;
+            else
+                usage();
+            opt_gpio = true;
+            break;
+        case 'm':
+            if (!parse_mood(optarg))
+                usage();
+            break;
+        case 'r':
+            if (!register_receiver(optarg))
+                return 1;
+            break;
+        case 'R':
+            if (!register_receivers_from_file(optarg))
+                return 1;
+            break;
+        case 'k':
+            if (!register_code_callback(optarg))
+                return 1;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (!current_receiver_number && !discovery_nb)
+        usage();
+    if (wait_free_timeout >= 0) {
+        rf.set_opt_wait_free_433(true, wait_free_timeout, true);
+        if (rf2)
+            rf2->set_opt_wait_free_433(true, wait_free_timeout, true);
+    }
+
+    if (optind == argc) {
+        if (!replay_capture(stdin, first_level))
+            return 1;
+    }
+    for (int i = optind; i < argc; ++i) {
+        FILE *f = fopen(argv[i], "r");
+        if (!f) {
+            perror(argv[i]);
+            return 1;
+        }
+        bool ok = replay_capture(f, first_level);
+        fclose(f);
+        if (!ok) {
+            fprintf(stderr, "%s: invalid capture file\n", argv[i]);
+            return 1;
+        }
+#ifdef RF433RECV_CALIBRATION
+        if (recalibrate_min_codes)
+            rf.recalibrate(recalibrate_min_codes);
+#endif
+    }
+
+#ifdef DEBUG_LATENCIES
+    if (output_latencies)
+        output_latencies_stats();
+#else
+    (void)output_latencies;
+#endif
+#ifdef RF433RECV_CALIBRATION
+    if (output_calibration_is_set)
+        output_calibration();
+#else
+    (void)recalibrate_min_codes;
+    (void)output_calibration_is_set;
+#endif
+#ifdef RF433RECV_CHANNEL_STATS
+    if (output_channel_stats_is_set)
+        output_channel_stats();
+#else
+    (void)output_channel_stats_is_set;
+#endif
+#ifdef RF433RECV_DISCOVERY
+    if (discovery_nb && !output_discovery())
+        return 1;
+#endif
+
+    return 0;
+}
+
+// vim: ts=4:sw=4:tw=80:et
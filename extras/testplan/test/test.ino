@@ -32,6 +32,12 @@
 
 #define ARRAYSZ(a) (sizeof(a) / sizeof(*a))
 
+#ifdef RF433RECV_TEST_ARENA
+    // Receivers and callbacks get allocated in this arena instead of on the
+    // heap
+static RF433StaticArena<RF433RECV_TEST_ARENA> arena;
+#endif
+
 extern const size_t timings_len;
 extern size_t timings_index;
 
@@ -97,6 +103,13 @@ void setup() {
 
     dbg_output_free_memory();
 
+#ifdef RF433RECV_TEST_ARENA
+    RF_manager::set_arena(&arena);
+#endif
+#ifdef RF433RECV_TEST_STRICT
+    rf.set_decode_mood(DecodeMood::STRICT);
+#endif
+
 #define reg1
 #define reg2
 #define reg3
@@ -408,8 +421,19 @@ void setup() {
 #endif
 
     rf.set_opt_wait_free_433(false);
+#ifdef RF433RECV_TEST_DEFERRED
+    rf.set_deferred_decoding(true);
+#endif
     rf.activate_interrupts_handler();
 
+#ifdef RF433RECV_TEST_ARENA
+    Serial.print(F("Arena: "));
+    Serial.print(arena.get_used());
+    Serial.print(F(" bytes used out of "));
+    Serial.print(arena.get_size());
+    Serial.print(F("\n"));
+#endif
+
     dbg_output_free_memory();
 }
 
@@ -421,13 +445,28 @@ void loop() {
     delay(1500);
     Serial.print(F("----- BEGIN TEST -----\n"));
     while (!has_read_all_timings()) {
+#ifdef RF433RECV_TEST_DEFERRED
+            // Signals get decoded by batches
+        for (byte i = 0; i < 8; ++i)
+            handle_int_receive();
+#elif defined(RF433RECV_TEST_BUSY)
+            // loop() is busy: signals get decoded by the interrupt handler, and
+            // do_events() is called only from time to time
+        for (uint16_t i = 0; i < RF433RECV_TEST_BUSY; ++i)
+            handle_int_receive();
+#else
         handle_int_receive();
+#endif
         rf.do_events();
     }
     Serial.print(F("----- END TEST -----\n"));
 
     dbg_output_free_memory();
 
+#ifdef RF433RECV_HOST
+    exit(0);
+#endif
+
     while (1)
         ;
 